@@ -0,0 +1,94 @@
+#!/bin/bash
+
+set -e  # Exit immediately on any error
+
+# Define defaults
+ROOT=""
+CROSS=""
+TOP=30
+
+# Function to display usage information
+usage() {
+    echo "Usage: $0 [-h] [-r root_dir] [-c cross_prefix] [-n lines] profile_file"
+    echo "Summarize a profile written by mt02-prof on the repeater."
+    echo "Options:"
+    echo "  -h            Display this help message and exit."
+    echo "  -r ROOT_DIR   Root filesystem with unstripped binaries, used to resolve user space symbols."
+    echo "  -c PREFIX     Toolchain prefix for addr2line and readelf (e.g. mips-openwrt-linux-musl-)."
+    echo "  -n LINES      Number of symbols to show (default ${TOP})."
+    exit 1
+}
+
+# Turn "u" lines into symbols, one addr2line call per binary
+resolve_user() {
+    local path file base
+    for path in $(awk '$1 == "u" && $4 != "[unknown]" { print $4 }' "$PROFILE" | sort -u); do
+        file="${ROOT}${path}"
+        if [ -z "$ROOT" ] || [ ! -f "$file" ]; then
+            awk -v path="$path" '$1 == "u" && $4 == path { print $2, $3, path "+0x" $5 }' "$PROFILE"
+            continue
+        fi
+        # Offsets are file offsets, non-PIE executables load above them
+        base=$("${CROSS}readelf" -lW "$file" | awk '$1 == "LOAD" && $2 ~ /^0x0+$/ { print $3; exit }')
+        base=$(( ${base:-0} ))
+        awk -v path="$path" '$1 == "u" && $4 == path { print $2, $3, $5 }' "$PROFILE" | \
+            while read -r count comm offset; do
+                printf '%s %s %x\n' "$count" "$comm" $(( 0x$offset + base ))
+            done > "$TMP"
+        cut -d ' ' -f 3 "$TMP" | "${CROSS}addr2line" -f -e "$file" | paste - - | \
+            paste -d ' ' "$TMP" - | \
+            awk -v name="${path##*/}" '{ sym = ($4 == "??") ? "0x" $3 : $4; print $1, $2, sym " [" name "]" }'
+    done
+    awk '$1 == "u" && $4 == "[unknown]" { print $2, $3, "[unknown]" }' "$PROFILE"
+}
+
+while getopts "hr:c:n:" opt; do
+    case "$opt" in
+        r) ROOT=${OPTARG%/} ;;
+        c) CROSS=$OPTARG ;;
+        n) TOP=$OPTARG ;;
+        *) usage ;;
+    esac
+done
+shift $(( OPTIND - 1 ))
+
+if [ $# -ne 1 ]; then
+    usage
+fi
+PROFILE=$1
+
+if [ "$(head -c 12 "$PROFILE")" != "mt02-prof 1 " ]; then
+    echo "Error: $PROFILE is not a mt02-prof profile."
+    exit 1
+fi
+if [ -n "$ROOT" ]; then
+    for tool in addr2line readelf; do
+        if ! command -v "${CROSS}${tool}" > /dev/null; then
+            echo "Error: ${CROSS}${tool} is required."
+            exit 1
+        fi
+    done
+fi
+
+TMP=$(mktemp)
+trap 'rm -f "$TMP"' EXIT
+
+read -r _ _ EVENT FREQ DURATION TOTAL LOST < "$PROFILE"
+echo "Event: $EVENT at $FREQ Hz for $DURATION s, $TOTAL samples ($LOST lost)"
+
+{
+    awk '$1 == "k" { print $2, $3, $4 " [kernel]" }' "$PROFILE"
+    resolve_user
+} > "$TMP.all"
+trap 'rm -f "$TMP" "$TMP.all"' EXIT
+
+echo
+echo "By process:"
+awk -v total="$TOTAL" '{ n[$2] += $1 } END { for (c in n) printf "%7.2f%%  %s\n", 100 * n[c] / total, c }' "$TMP.all" | \
+    sort -rn | head -n "$TOP"
+
+echo
+echo "By symbol:"
+awk -v total="$TOTAL" '{ sym = $0; sub(/^[^ ]+ [^ ]+ /, "", sym); n[$2 "\t" sym] += $1 }
+    END { for (k in n) { split(k, f, "\t"); printf "%7.2f%%  %-16s %s\n", 100 * n[k] / total, f[1], f[2] } }' "$TMP.all" | \
+    sort -rn | head -n "$TOP"
@@ -0,0 +1,16 @@
+#!/bin/bash
+
+# Helpers shared by the benchmark scripts, sourced by them.
+# SERVER, DURATION and STREAMS are set by the calling script.
+
+# Run one iperf3 test in each direction and print the results in Mbit/s
+run_iperf() {
+    local label=$1 dir dir_label rate
+    for dir in "" "-R"; do
+        rate=$(iperf3 -c "$SERVER" -t "$DURATION" -P "$STREAMS" $dir -J | \
+            jq '.end.sum_received.bits_per_second / 1000000 | floor')
+        dir_label=${dir:+(download)}
+        [ -z "$dir" ] && dir_label="(upload)"
+        echo "$label ${dir_label}: ${rate} Mbit/s"
+    done
+}
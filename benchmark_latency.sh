@@ -0,0 +1,73 @@
+#!/bin/bash
+
+set -e  # Exit immediately on any error
+
+# Define defaults
+DURATION=30
+STREAMS=4
+INTERVAL=0.2
+
+# Function to display usage information
+usage() {
+    echo "Usage: $0 [-h] [-t seconds] [-P streams] [-p ping_target] iperf3_server"
+    echo "Measure latency under load over WiFi: ping while idle, then while bulk iperf3 flows run in each direction."
+    echo "Run it on a WiFi client of the repeater, with an iperf3 server (iperf3 -s) on the wired side."
+    echo "Options:"
+    echo "  -h            Display this help message and exit."
+    echo "  -t SECONDS    Duration of each phase (default ${DURATION})."
+    echo "  -P STREAMS    Number of parallel bulk streams (default ${STREAMS})."
+    echo "  -p TARGET     Host to ping (default: the iperf3 server)."
+    exit 1
+}
+
+# Ping the target for the given duration and print min/median/p95/max RTT in ms
+run_ping() {
+    local label=$1
+    ping -i "$INTERVAL" -w "$DURATION" "$TARGET" | \
+        sed -n 's/.*time=\([0-9.]*\).*/\1/p' | sort -n | \
+        awk -v label="$label" '{ rtt[NR] = $1 }
+            END {
+                if (NR == 0) { print label ": no replies"; exit }
+                p95 = int(NR * 0.95)
+                if (p95 < 1) p95 = 1
+                printf "%s: min %.1f median %.1f p95 %.1f max %.1f ms (%d replies)\n", label,
+                    rtt[1], rtt[int((NR + 1) / 2)], rtt[p95], rtt[NR], NR
+            }'
+}
+
+# Ping while bulk iperf3 flows run in the given direction
+run_loaded() {
+    local label=$1 dir=$2 pid
+    iperf3 -c "$SERVER" -t $(( DURATION + 2 )) -P "$STREAMS" $dir > /dev/null &
+    pid=$!
+    sleep 1
+    run_ping "$label"
+    wait "$pid"
+}
+
+while getopts "ht:P:p:" opt; do
+    case "$opt" in
+        t) DURATION=$OPTARG ;;
+        P) STREAMS=$OPTARG ;;
+        p) TARGET=$OPTARG ;;
+        *) usage ;;
+    esac
+done
+shift $(( OPTIND - 1 ))
+
+if [ $# -ne 1 ]; then
+    usage
+fi
+SERVER=$1
+TARGET=${TARGET:-$SERVER}
+
+for tool in iperf3 ping; do
+    if ! command -v "$tool" > /dev/null; then
+        echo "Error: $tool is required."
+        exit 1
+    fi
+done
+
+run_ping "Idle    "
+run_loaded "Upload  " ""
+run_loaded "Download" "-R"
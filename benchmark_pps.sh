@@ -0,0 +1,69 @@
+#!/bin/bash
+
+set -e  # Exit immediately on any error
+
+# Define defaults
+DEVICE="root@192.168.1.1"
+DURATION=30
+LENGTH=64
+IFACE="eth0"
+
+# Function to display usage information
+usage() {
+    echo "Usage: $0 [-h] [-d user@device] [-t seconds] [-l bytes] [-i interface] iperf3_server"
+    echo "Measure the small packet rate routed by the repeater and the Ethernet interrupts it takes."
+    echo "Run it on a host connected to the LAN side, with an iperf3 server (iperf3 -s) reachable through the WAN side."
+    echo "Options:"
+    echo "  -h            Display this help message and exit."
+    echo "  -d DEVICE     SSH destination of the repeater (default ${DEVICE})."
+    echo "  -t SECONDS    Duration of the run (default ${DURATION})."
+    echo "  -l BYTES      UDP payload length (default ${LENGTH})."
+    echo "  -i INTERFACE  Receiving interface on the repeater (default ${IFACE})."
+    exit 1
+}
+
+# Print the RX packet count and the interrupt count of the interface on the repeater,
+# ag71xx requests its interrupt under the platform device name (e.g. 19000000.eth)
+sample() {
+    ssh "$DEVICE" "cat /sys/class/net/$IFACE/statistics/rx_packets; \
+        irq=\$(basename \$(readlink /sys/class/net/$IFACE/device)); \
+        awk -v irq=\"\$irq\" '\$NF == irq { for (i = 2; i <= NF && \$i ~ /^[0-9]+\$/; i++) n += \$i } END { print n + 0 }' /proc/interrupts"
+}
+
+while getopts "hd:t:l:i:" opt; do
+    case "$opt" in
+        d) DEVICE=$OPTARG ;;
+        t) DURATION=$OPTARG ;;
+        l) LENGTH=$OPTARG ;;
+        i) IFACE=$OPTARG ;;
+        *) usage ;;
+    esac
+done
+shift $(( OPTIND - 1 ))
+
+if [ $# -ne 1 ]; then
+    usage
+fi
+SERVER=$1
+
+for tool in iperf3 jq ssh; do
+    if ! command -v "$tool" > /dev/null; then
+        echo "Error: $tool is required."
+        exit 1
+    fi
+done
+
+echo "napi_defer_hard_irqs: $(ssh "$DEVICE" "cat /sys/class/net/$IFACE/napi_defer_hard_irqs"), gro_flush_timeout: $(ssh "$DEVICE" "cat /sys/class/net/$IFACE/gro_flush_timeout") ns"
+
+read -r -d '' PKTS_START IRQS_START < <(sample) || true
+RESULT=$(iperf3 -c "$SERVER" -u -b 0 -l "$LENGTH" -t "$DURATION" -J)
+read -r -d '' PKTS_END IRQS_END < <(sample) || true
+
+PKTS=$(( PKTS_END - PKTS_START ))
+IRQS=$(( IRQS_END - IRQS_START ))
+if [ "$IRQS" -eq 0 ]; then
+    IRQS=1
+fi
+
+echo "Received by $IFACE: $(( PKTS / DURATION )) pps, $(( IRQS / DURATION )) interrupts/s, $(( PKTS / IRQS )) packets per interrupt"
+echo "Delivered to the server: $(echo "$RESULT" | jq '.end.sum.packets - .end.sum.lost_packets') packets, $(echo "$RESULT" | jq '.end.sum.lost_percent | floor')% lost"
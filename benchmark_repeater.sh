@@ -0,0 +1,74 @@
+#!/bin/bash
+
+set -e  # Exit immediately on any error
+
+# Shared helpers (run_iperf)
+. "$(dirname "$0")/benchmark_common.sh"
+
+# Define defaults
+DEVICE="root@192.168.1.1"
+DURATION=30
+STREAMS=4
+
+# Function to display usage information
+usage() {
+    echo "Usage: $0 [-h] [-d user@device] [-t seconds] [-P streams] iperf3_server"
+    echo "Compare throughput through the repeater uplink in 4-address (WDS) mode and in relayd mode."
+    echo "Run it on a host connected to the repeater, with an iperf3 server (iperf3 -s) on the upstream network."
+    echo "The uplink must already be configured with mt02-repeater, the repeater is then reached at its address from the upstream DHCP server."
+    echo "Options:"
+    echo "  -h            Display this help message and exit."
+    echo "  -d DEVICE     SSH destination of the repeater on the upstream network (default ${DEVICE})."
+    echo "  -t SECONDS    Duration of each run (default ${DURATION})."
+    echo "  -P STREAMS    Number of parallel streams (default ${STREAMS})."
+    exit 1
+}
+
+# Switch the uplink mode and wait until the server is reachable again
+set_mode() {
+    local tries=60
+    # -n, so the 4-address check can't switch wds to relay mid-run
+    ssh "$DEVICE" "mt02-repeater -n $1" > /dev/null
+    sleep 5
+    until ping -c 1 -W 1 "$SERVER" > /dev/null 2>&1; do
+        tries=$(( tries - 1 ))
+        if [ $tries -eq 0 ]; then
+            echo "Error: $SERVER not reachable in $1 mode."
+            exit 1
+        fi
+    done
+}
+
+while getopts "hd:t:P:" opt; do
+    case "$opt" in
+        d) DEVICE=$OPTARG ;;
+        t) DURATION=$OPTARG ;;
+        P) STREAMS=$OPTARG ;;
+        *) usage ;;
+    esac
+done
+shift $(( OPTIND - 1 ))
+
+if [ $# -ne 1 ]; then
+    usage
+fi
+SERVER=$1
+
+for tool in iperf3 jq ssh; do
+    if ! command -v "$tool" > /dev/null; then
+        echo "Error: $tool is required."
+        exit 1
+    fi
+done
+
+ORIGINAL=$(ssh "$DEVICE" "uci -q get wireless.mt02_uplink.mt02_mode || true")
+if [ -z "$ORIGINAL" ]; then
+    echo "Error: repeater uplink is not configured."
+    exit 1
+fi
+trap 'ssh "$DEVICE" "mt02-repeater $ORIGINAL" > /dev/null' EXIT
+
+set_mode wds
+run_iperf "WDS  "
+set_mode relay
+run_iperf "relay"
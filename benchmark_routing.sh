@@ -0,0 +1,59 @@
+#!/bin/bash
+
+set -e  # Exit immediately on any error
+
+# Shared helpers (run_iperf)
+. "$(dirname "$0")/benchmark_common.sh"
+
+# Define defaults
+DEVICE="root@192.168.1.1"
+DURATION=30
+STREAMS=4
+
+# Function to display usage information
+usage() {
+    echo "Usage: $0 [-h] [-d user@device] [-t seconds] [-P streams] iperf3_server"
+    echo "Measure routed LAN -> WAN throughput through the repeater with and without flow offloading."
+    echo "Run it on a host connected to the LAN side, with an iperf3 server (iperf3 -s) reachable through the WAN side."
+    echo "Options:"
+    echo "  -h            Display this help message and exit."
+    echo "  -d DEVICE     SSH destination of the repeater (default ${DEVICE})."
+    echo "  -t SECONDS    Duration of each run (default ${DURATION})."
+    echo "  -P STREAMS    Number of parallel streams (default ${STREAMS})."
+    exit 1
+}
+
+# Switch flow offloading on the repeater and reload the firewall
+set_offloading() {
+    ssh "$DEVICE" "uci set firewall.@defaults[0].flow_offloading='$1' && uci commit firewall && fw4 -q reload"
+}
+
+while getopts "hd:t:P:" opt; do
+    case "$opt" in
+        d) DEVICE=$OPTARG ;;
+        t) DURATION=$OPTARG ;;
+        P) STREAMS=$OPTARG ;;
+        *) usage ;;
+    esac
+done
+shift $(( OPTIND - 1 ))
+
+if [ $# -ne 1 ]; then
+    usage
+fi
+SERVER=$1
+
+for tool in iperf3 jq ssh; do
+    if ! command -v "$tool" > /dev/null; then
+        echo "Error: $tool is required."
+        exit 1
+    fi
+done
+
+ORIGINAL=$(ssh "$DEVICE" "uci -q get firewall.@defaults[0].flow_offloading || echo 0")
+trap 'set_offloading "$ORIGINAL"' EXIT
+
+set_offloading 0
+run_iperf "Without offloading"
+set_offloading 1
+run_iperf "With offloading   "
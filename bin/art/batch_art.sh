@@ -0,0 +1,203 @@
+#!/bin/bash
+
+set -e  # Exit immediately on any error
+
+# Offsets of the fields patched into the blank ART partition, see initialize_art.sh
+OFF_MAC_BASE=$((0x1002))   # base MAC
+OFF_MAC_1=$((0x06))        # base +1
+OFF_MAC_2=$((0x00))        # base +2
+OFF_MAC_3=$((0x5002))      # base +3
+OFF_SERIAL=$((0x5900))     # 14 character random string
+SERIAL_LEN=14
+
+# Every device takes four consecutive MAC addresses
+MACS_PER_DEVICE=4
+
+# Function to display usage instructions
+print_help() {
+    echo "Usage: $0 -b <path_to_art_blank.bin> -o <output_dir> (-r <first_base_mac> -n <count> | -c <macs.csv>) [-u <used_macs.txt>] [-j <jobs>]"
+    echo "Generate one initialized ART partition per device."
+    echo "  -r, -n : Allocate <count> devices starting at <first_base_mac>, ${MACS_PER_DEVICE} MAC addresses apart."
+    echo "  -c     : Read base MAC addresses from the first column of a CSV file, one device per line."
+    echo "  -u     : File with MAC addresses already assigned in earlier runs, one per line."
+    echo "           New addresses are checked against it and appended to it after a successful run."
+    echo "  -j     : Number of images written in parallel (default: number of CPUs)."
+    echo "Base MAC address format: XX:XX:XX:XX:XX:XX (hexadecimal)"
+    echo "Example: $0 -b MT9533/art_blank.bin -o out -r AA:BB:CC:01:02:00 -n 1000"
+    exit 1
+}
+
+# Function to validate MAC address format using regex
+validate_mac() {
+    if [[ ! "$1" =~ ^([0-9A-Fa-f]{2}:){5}[0-9A-Fa-f]{2}$ ]]; then
+        echo "Error: Invalid MAC address format '$1'."
+        exit 1
+    fi
+}
+
+# Convert XX:XX:XX:XX:XX:XX to a 48-bit integer
+mac_to_int() {
+    echo $(( 0x${1//:/} ))
+}
+
+# Convert a 48-bit integer to XX:XX:XX:XX:XX:XX
+int_to_mac() {
+    local hex=$(printf "%012X" "$1")
+    echo "${hex:0:2}:${hex:2:2}:${hex:4:2}:${hex:6:2}:${hex:8:2}:${hex:10:2}"
+}
+
+# Build one ART image from the blank segments, the fields are spliced in between them
+# Arguments: base MAC as integer, serial string
+make_image() {
+    local base=$1 serial=$2 name bytes i
+    local mac=()
+    for i in 0 1 2 3; do
+        bytes=$(printf "%012x" $(( base + i )))
+        mac[i]="\\x${bytes:0:2}\\x${bytes:2:2}\\x${bytes:4:2}\\x${bytes:6:2}\\x${bytes:8:2}\\x${bytes:10:2}"
+    done
+    name=$(printf "art_%012X.bin" "$base")
+    {
+        printf "${mac[2]}"
+        printf "${mac[1]}"
+        cat "$SEG_DIR/1"
+        printf "${mac[0]}"
+        cat "$SEG_DIR/2"
+        printf "${mac[3]}"
+        cat "$SEG_DIR/3"
+        printf "%s" "$serial"
+        cat "$SEG_DIR/4"
+    } > "$OUT_DIR/$name"
+}
+
+# --- Main Script ---
+
+BLANK_FILE=""
+OUT_DIR=""
+FIRST_MAC=""
+COUNT=""
+CSV_FILE=""
+USED_FILE=""
+JOBS=$(nproc)
+
+while getopts "hb:o:r:n:c:u:j:" opt; do
+    case "$opt" in
+        b) BLANK_FILE=$OPTARG ;;
+        o) OUT_DIR=$OPTARG ;;
+        r) FIRST_MAC=$OPTARG ;;
+        n) COUNT=$OPTARG ;;
+        c) CSV_FILE=$OPTARG ;;
+        u) USED_FILE=$OPTARG ;;
+        j) JOBS=$OPTARG ;;
+        *) print_help ;;
+    esac
+done
+
+if [ -z "$BLANK_FILE" ] || [ -z "$OUT_DIR" ]; then
+    print_help
+fi
+if [ -n "$FIRST_MAC" ] && [ -n "$CSV_FILE" ] || [ -z "$FIRST_MAC$CSV_FILE" ]; then
+    print_help
+fi
+
+# Check if file exists
+if [ ! -f "$BLANK_FILE" ]; then
+    echo "Error: File '$BLANK_FILE' not found."
+    exit 1
+fi
+if [ "$(stat -c %s "$BLANK_FILE")" -le $(( OFF_SERIAL + SERIAL_LEN )) ]; then
+    echo "Error: File '$BLANK_FILE' is too small to be an ART partition."
+    exit 1
+fi
+
+mkdir -p "$OUT_DIR"
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "$WORK_DIR"' EXIT
+SEG_DIR="$WORK_DIR/seg"
+mkdir "$SEG_DIR"
+
+# Collect the base MAC of every device, one integer per line
+if [ -n "$FIRST_MAC" ]; then
+    validate_mac "$FIRST_MAC"
+    if [[ ! "$COUNT" =~ ^[0-9]+$ ]] || [ "$COUNT" -eq 0 ]; then
+        echo "Error: Invalid device count '$COUNT'."
+        exit 1
+    fi
+    first=$(mac_to_int "$FIRST_MAC")
+    for (( i = 0; i < COUNT; i++ )); do
+        echo $(( first + i * MACS_PER_DEVICE ))
+    done > "$WORK_DIR/bases"
+else
+    if [ ! -f "$CSV_FILE" ]; then
+        echo "Error: File '$CSV_FILE' not found."
+        exit 1
+    fi
+    : > "$WORK_DIR/bases"
+    while IFS=, read -r mac _; do
+        mac=${mac//[[:space:]\"]/}
+        # Skip empty lines and a header line
+        if [ -z "$mac" ] || [[ "$mac" =~ ^[A-Za-z]+$ ]]; then
+            continue
+        fi
+        validate_mac "$mac"
+        mac_to_int "$mac" >> "$WORK_DIR/bases"
+    done < "$CSV_FILE"
+fi
+
+DEVICES=$(wc -l < "$WORK_DIR/bases")
+if [ "$DEVICES" -eq 0 ]; then
+    echo "Error: No devices to generate."
+    exit 1
+fi
+echo "Generating ART partitions for $DEVICES device(s)..."
+
+# All four MACs of a device must share the first 3 bytes, and no MAC may be used twice
+while read -r base; do
+    if [ $(( (base & 0xFFFFFF) + MACS_PER_DEVICE - 1 )) -gt $((0xFFFFFF)) ]; then
+        echo "Error: Cannot generate ${MACS_PER_DEVICE} consecutive MAC addresses from $(int_to_mac "$base") without overflowing first 3 bytes." >&2
+        exit 1
+    fi
+    for (( i = 0; i < MACS_PER_DEVICE; i++ )); do
+        printf "%012X\n" $(( base + i ))
+    done
+done < "$WORK_DIR/bases" > "$WORK_DIR/macs"
+
+{
+    cat "$WORK_DIR/macs"
+    if [ -n "$USED_FILE" ] && [ -f "$USED_FILE" ]; then
+        tr -d ':' < "$USED_FILE" | tr 'a-f' 'A-F'
+    fi
+} | sort | uniq -d > "$WORK_DIR/dups"
+if [ -s "$WORK_DIR/dups" ]; then
+    echo "Error: MAC address collision, $(wc -l < "$WORK_DIR/dups") address(es) used more than once, first: $(head -n1 "$WORK_DIR/dups")."
+    exit 1
+fi
+
+# Draw a unique serial for every device
+tr -dc 'A-Z0-9' < /dev/urandom | fold -w "$SERIAL_LEN" | awk -v n="$DEVICES" \
+    '!seen[$0]++ { print; if (++count == n) exit }' > "$WORK_DIR/serials"
+
+# Split the blank partition once into the parts kept between the patched fields
+tail -c +$(( OFF_MAC_1 + 6 + 1 )) "$BLANK_FILE" | head -c $(( OFF_MAC_BASE - OFF_MAC_1 - 6 )) > "$SEG_DIR/1"
+tail -c +$(( OFF_MAC_BASE + 6 + 1 )) "$BLANK_FILE" | head -c $(( OFF_MAC_3 - OFF_MAC_BASE - 6 )) > "$SEG_DIR/2"
+tail -c +$(( OFF_MAC_3 + 6 + 1 )) "$BLANK_FILE" | head -c $(( OFF_SERIAL - OFF_MAC_3 - 6 )) > "$SEG_DIR/3"
+tail -c +$(( OFF_SERIAL + SERIAL_LEN + 1 )) "$BLANK_FILE" > "$SEG_DIR/4"
+
+# Write the images in parallel
+export SEG_DIR OUT_DIR
+export -f make_image
+paste -d' ' "$WORK_DIR/bases" "$WORK_DIR/serials" | \
+    xargs -P "$JOBS" -n 2 bash -c 'make_image "$@"' _
+
+# Record what was assigned in this run
+paste -d, <(while read -r base; do int_to_mac "$base"; done < "$WORK_DIR/bases") \
+          "$WORK_DIR/serials" | \
+    awk -F, -v dir="$OUT_DIR" 'BEGIN { print "file,base_mac,serial" }
+        { m = $1; gsub(":", "", m); printf "%s/art_%s.bin,%s,%s\n", dir, m, $1, $2 }' \
+    > "$OUT_DIR/manifest.csv"
+if [ -n "$USED_FILE" ]; then
+    while read -r mac; do
+        int_to_mac $(( 0x$mac ))
+    done < "$WORK_DIR/macs" >> "$USED_FILE"
+fi
+
+echo "Wrote $DEVICES ART partition(s) to '$OUT_DIR', see '$OUT_DIR/manifest.csv'."
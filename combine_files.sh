@@ -1,62 +1,186 @@
 #!/bin/bash
 
-# Define constants
+set -e  # Exit immediately on any error
+
+# Flash layout shared with the OpenWRT DTS partition nodes
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+LAYOUT_FILE="${SCRIPT_DIR}/openwrt/target/linux/ath79/dts/mt02_m300_layout.h"
+
+# Define defaults
 OUTPUT_FILE="firmware_image.bin"
 FILE_SIZE_MB=16
 
-# Function to create a file filled with 0xFF bytes
-create_filled_file() {
-    echo "Creating a ${FILE_SIZE_MB} MiB file filled with 0xFF values..."
-    dd if=/dev/zero bs=1M count="${FILE_SIZE_MB}" | tr '\000' '\377' > "${OUTPUT_FILE}"
-    echo "File ${OUTPUT_FILE} created."
-}
+# uImage header magic, stored big-endian at the start of the firmware
+UIMAGE_MAGIC="27051956"
+
+# U-Boot and its SPL start with an unconditional branch ("b reset") in start.S
+UBOOT_BRANCH="1000"
 
 # Function to display usage information
 usage() {
-    echo "Usage: $0 [-h] uboot.bin art.bin openwrt.bin [uboot-env.bin]"
+    echo "Usage: $0 [-h] [-s 8|16|32] [-o output.bin] uboot.bin art.bin openwrt.bin [uboot-env.bin]"
     echo "Combine uboot.bin, art.bin, openwrt.bin, and optionally uboot-env.bin into a single binary file."
-    echo "Offsets:"
-    echo "  uboot.bin     : Starts at the beginning (offset 0x000000)."
-    echo "  uboot-env.bin : Optional, starts at offset 0x050000 (320KB)."
-    echo "  art.bin       : Starts at offset 0x060000 (384KB)."
-    echo "  openwrt.bin   : Starts at offset 0x070000 (448KB)."
+    echo "Offsets and sizes are read from ${LAYOUT_FILE#"${SCRIPT_DIR}"/}:"
+    echo "  uboot.bin     : Starts at offset 0x$(printf "%06X" "$MT02_UBOOT_OFFSET"), at most 0x$(printf "%X" "$MT02_UBOOT_SIZE") bytes."
+    echo "  uboot-env.bin : Optional, starts at offset 0x$(printf "%06X" "$MT02_ENV_OFFSET"), at most 0x$(printf "%X" "$MT02_ENV_SIZE") bytes."
+    echo "  art.bin       : Starts at offset 0x$(printf "%06X" "$MT02_ART_OFFSET"), at most 0x$(printf "%X" "$MT02_ART_SIZE") bytes."
+    echo "  openwrt.bin   : Starts at offset 0x$(printf "%06X" "$MT02_FIRMWARE_OFFSET"), fills the rest of the flash."
+    echo "Checked before writing: uboot.bin starts with a MIPS branch and carries a U-Boot version string,"
+    echo "uboot-env.bin has a valid big-endian CRC32 (mkenvimage -b -s 0x$(printf "%X" "$MT02_ENV_SIZE")) and"
+    echo "openwrt.bin starts with a uImage header. art.bin is only checked for its size."
     echo "Options:"
     echo "  -h            Display this help message and exit."
+    echo "  -s SIZE       Flash chip size in MiB: 8, 16 or 32 (default ${FILE_SIZE_MB})."
+    echo "  -o FILE       Output file (default ${OUTPUT_FILE})."
     exit 1
 }
 
-# Check if -h option is passed
-if [[ "$1" == "-h" ]]; then
-    usage
-fi
+# Read "#define MT02_<NAME>_OFFSET/_SIZE 0x..." entries from the layout header
+read_layout() {
+    if [ ! -f "$LAYOUT_FILE" ]; then
+        echo "Error: Layout file $LAYOUT_FILE not found."
+        exit 1
+    fi
+    local name value
+    while read -r _ name value _; do
+        if [[ "$value" =~ ^0x[0-9A-Fa-f]+$ ]]; then
+            printf -v "$name" "%d" "$value"
+        fi
+    done < <(grep -E '^#define[[:space:]]+MT02_[A-Z]+_(OFFSET|SIZE)[[:space:]]' "$LAYOUT_FILE")
+    for name in MT02_UBOOT_OFFSET MT02_UBOOT_SIZE MT02_ENV_OFFSET MT02_ENV_SIZE \
+                MT02_ART_OFFSET MT02_ART_SIZE MT02_FIRMWARE_OFFSET; do
+        if [ -z "${!name}" ]; then
+            echo "Error: $name missing from $LAYOUT_FILE."
+            exit 1
+        fi
+    done
+}
+
+# Check that a blob exists and fits in its partition
+check_blob() {
+    local file=$1 limit=$2 label=$3
+    if [ ! -f "$file" ]; then
+        echo "Error: $label file '$file' not found."
+        exit 1
+    fi
+    local size=$(stat -c %s "$file")
+    if [ "$size" -eq 0 ]; then
+        echo "Error: $label file '$file' is empty."
+        exit 1
+    fi
+    if [ "$size" -gt "$limit" ]; then
+        echo "Error: $label file '$file' is $size bytes, partition holds only $limit bytes."
+        exit 1
+    fi
+}
+
+# Print the CRC32 (as used by U-Boot) of stdin in hex, taken from the gzip trailer
+crc32() {
+    gzip -c | tail -c 8 | head -c 4 | od -An -tx1 | awk '{ print $4 $3 $2 $1 }'
+}
+
+# Write count bytes of 0xFF (erased flash) to stdout
+pad() {
+    head -c "$1" /dev/zero | tr '\000' '\377'
+}
+
+# Write a blob followed by 0xFF padding up to the partition size
+emit_blob() {
+    local file=$1 limit=$2 size=0
+    if [ -n "$file" ]; then
+        cat "$file"
+        size=$(stat -c %s "$file")
+    fi
+    pad $(( limit - size ))
+}
+
+read_layout
+
+while getopts "hs:o:" opt; do
+    case "$opt" in
+        s) FILE_SIZE_MB=$OPTARG ;;
+        o) OUTPUT_FILE=$OPTARG ;;
+        *) usage ;;
+    esac
+done
+shift $(( OPTIND - 1 ))
 
 # Check if at least three required arguments are provided
 if [ $# -lt 3 ] || [ $# -gt 4 ]; then
     usage
 fi
 
+case "$FILE_SIZE_MB" in
+    8|16|32) ;;
+    *) echo "Error: Unsupported flash size ${FILE_SIZE_MB} MiB."; exit 1 ;;
+esac
+
 UBOOT_FILE=$1
 ART_FILE=$2
 OPENWRT_FILE=$3
 UBOOT_ENV_FILE=$4
 
-# Ensure the output file exists and is filled with 0xFF bytes
-if [ ! -f "$OUTPUT_FILE" ]; then
-    create_filled_file
+FLASH_SIZE=$(( FILE_SIZE_MB * 1024 * 1024 ))
+MT02_FIRMWARE_SIZE=$(( FLASH_SIZE - MT02_FIRMWARE_OFFSET ))
+
+# The partitions must follow each other without gaps for a single pass
+if [ $(( MT02_UBOOT_OFFSET )) -ne 0 ] || \
+   [ $(( MT02_UBOOT_OFFSET + MT02_UBOOT_SIZE )) -ne "$MT02_ENV_OFFSET" ] || \
+   [ $(( MT02_ENV_OFFSET + MT02_ENV_SIZE )) -ne "$MT02_ART_OFFSET" ] || \
+   [ $(( MT02_ART_OFFSET + MT02_ART_SIZE )) -ne "$MT02_FIRMWARE_OFFSET" ]; then
+    echo "Error: Partitions in $LAYOUT_FILE are not contiguous."
+    exit 1
+fi
+
+check_blob "$UBOOT_FILE" "$MT02_UBOOT_SIZE" "U-Boot"
+check_blob "$ART_FILE" "$MT02_ART_SIZE" "ART"
+check_blob "$OPENWRT_FILE" "$MT02_FIRMWARE_SIZE" "OpenWRT"
+if [ -n "$UBOOT_ENV_FILE" ]; then
+    check_blob "$UBOOT_ENV_FILE" "$MT02_ENV_SIZE" "U-Boot env"
+fi
+
+# OpenWRT must start with a uImage header, the firmware partition parser relies on it
+magic=$(head -c 4 "$OPENWRT_FILE" | od -An -tx1 | tr -d ' \n')
+if [ "$magic" != "$UIMAGE_MAGIC" ]; then
+    echo "Error: '$OPENWRT_FILE' does not start with a uImage header."
+    exit 1
 fi
 
-# Append uboot.bin at the beginning
-dd if="$UBOOT_FILE" of="$OUTPUT_FILE" bs=512 seek=0 conv=notrunc
+# U-Boot (or SPL) must be a MIPS image built from U-Boot sources
+branch=$(head -c 2 "$UBOOT_FILE" | od -An -tx1 | tr -d ' \n')
+if [ "$branch" != "$UBOOT_BRANCH" ] || ! grep -aqE 'U-Boot (SPL )?20[0-9]{2}\.' "$UBOOT_FILE"; then
+    echo "Error: '$UBOOT_FILE' does not look like a MIPS U-Boot binary."
+    exit 1
+fi
 
-# Append uboot-env.bin at offset 0x050000 (320KB) if provided
+# The env is read back with its CRC32 over the whole partition, minus the CRC itself
 if [ -n "$UBOOT_ENV_FILE" ]; then
-    dd if="$UBOOT_ENV_FILE" of="$OUTPUT_FILE" bs=512 seek=640 conv=notrunc
+    env_crc=$(head -c 4 "$UBOOT_ENV_FILE" | od -An -tx1 | tr -d ' \n')
+    data_crc=$(emit_blob "$UBOOT_ENV_FILE" "$MT02_ENV_SIZE" | tail -c +5 | crc32)
+    if [ "$env_crc" != "$data_crc" ]; then
+        echo "Error: '$UBOOT_ENV_FILE' has CRC32 $env_crc, its contents give $data_crc."
+        exit 1
+    fi
 fi
 
-# Append art.bin at offset 0x060000 (384KB)
-dd if="$ART_FILE" of="$OUTPUT_FILE" bs=512 seek=768 conv=notrunc
+# Build the whole image in a single pass into a temporary file next to the output
+TMP_FILE=$(mktemp "${OUTPUT_FILE}.XXXXXX")
+trap 'rm -f "$TMP_FILE"' EXIT
+
+{
+    emit_blob "$UBOOT_FILE" "$MT02_UBOOT_SIZE"
+    emit_blob "$UBOOT_ENV_FILE" "$MT02_ENV_SIZE"
+    emit_blob "$ART_FILE" "$MT02_ART_SIZE"
+    emit_blob "$OPENWRT_FILE" "$MT02_FIRMWARE_SIZE"
+} > "$TMP_FILE"
+
+if [ "$(stat -c %s "$TMP_FILE")" -ne "$FLASH_SIZE" ]; then
+    echo "Error: Combined image has unexpected size."
+    exit 1
+fi
 
-# Append openwrt.bin at offset 0x070000 (448KB)
-dd if="$OPENWRT_FILE" of="$OUTPUT_FILE" bs=512 seek=896 conv=notrunc
+chmod 644 "$TMP_FILE"
+mv "$TMP_FILE" "$OUTPUT_FILE"
+trap - EXIT
 
-echo "Combined image created: $OUTPUT_FILE"
+echo "Combined ${FILE_SIZE_MB} MiB image created: $OUTPUT_FILE"
@@ -0,0 +1,97 @@
+#!/bin/bash
+
+set -e  # Exit immediately on any error
+
+# Define defaults
+BLOCK_SIZE=65536
+OUTPUT_PREFIX="delta"
+
+# Function to display usage information
+usage() {
+    echo "Usage: $0 [-h] [-b block_size] [-o prefix] old.bin new.bin"
+    echo "Compare two flash images (e.g. a readback dump and a new combined image) and list the erase blocks that differ."
+    echo "Outputs:"
+    echo "  <prefix>.layout : flashrom layout with one region per run of changed blocks."
+    echo "  <prefix>.txt    : The same runs as 'offset size' pairs, one per line."
+    echo "Options:"
+    echo "  -h            Display this help message and exit."
+    echo "  -b SIZE       Erase block size in bytes (default ${BLOCK_SIZE})."
+    echo "  -o PREFIX     Prefix of the output files (default ${OUTPUT_PREFIX})."
+    echo "Program only the changed regions with:"
+    echo "  flashrom -p ch341a_spi -w new.bin --layout <prefix>.layout \$(sed 's/^.* /-i /' <prefix>.layout)"
+    exit 1
+}
+
+# Print one md5 sum per block of the given file
+block_sums() {
+    split -b "$BLOCK_SIZE" --filter='md5sum' "$1" | cut -d' ' -f1
+}
+
+while getopts "hb:o:" opt; do
+    case "$opt" in
+        b) BLOCK_SIZE=$OPTARG ;;
+        o) OUTPUT_PREFIX=$OPTARG ;;
+        *) usage ;;
+    esac
+done
+shift $(( OPTIND - 1 ))
+
+if [ $# -ne 2 ]; then
+    usage
+fi
+
+OLD_FILE=$1
+NEW_FILE=$2
+
+for file in "$OLD_FILE" "$NEW_FILE"; do
+    if [ ! -f "$file" ]; then
+        echo "Error: File '$file' not found."
+        exit 1
+    fi
+done
+
+if [[ ! "$BLOCK_SIZE" =~ ^[0-9]+$ ]] || [ "$BLOCK_SIZE" -eq 0 ]; then
+    echo "Error: Invalid block size '$BLOCK_SIZE'."
+    exit 1
+fi
+
+IMAGE_SIZE=$(stat -c %s "$NEW_FILE")
+if [ "$(stat -c %s "$OLD_FILE")" -ne "$IMAGE_SIZE" ]; then
+    echo "Error: Images differ in size, the whole chip has to be programmed."
+    exit 1
+fi
+if [ $(( IMAGE_SIZE % BLOCK_SIZE )) -ne 0 ]; then
+    echo "Error: Image size is not a multiple of the block size."
+    exit 1
+fi
+
+# Walk both block sum lists side by side and merge adjacent changed blocks into runs
+paste -d' ' <(block_sums "$OLD_FILE") <(block_sums "$NEW_FILE") | \
+awk -v bs="$BLOCK_SIZE" -v layout="${OUTPUT_PREFIX}.layout" -v list="${OUTPUT_PREFIX}.txt" '
+    function flush() {
+        if (start < 0)
+            return
+        printf "0x%08x:0x%08x delta_%d\n", start * bs, (end + 1) * bs - 1, runs > layout
+        printf "0x%06X 0x%06X\n", start * bs, (end - start + 1) * bs > list
+        runs++
+        start = -1
+    }
+    BEGIN { start = -1; runs = 0; changed = 0 }
+    {
+        if ($1 != $2) {
+            if (start < 0)
+                start = NR - 1
+            end = NR - 1
+            changed++
+        } else {
+            flush()
+        }
+    }
+    END {
+        flush()
+        printf "" > layout
+        printf "" > list
+        printf "%d of %d blocks changed in %d region(s).\n", changed, NR, runs
+    }'
+
+echo "Layout written to ${OUTPUT_PREFIX}.layout, block list to ${OUTPUT_PREFIX}.txt"
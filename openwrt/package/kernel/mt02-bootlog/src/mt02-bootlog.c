@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Copyright (C) 2024 Wojciech Cybowski <github.com/wcyb>
+ *
+ * Reads the console output U-Boot recorded during a quiet boot. U-Boot
+ * puts it into a RAM area which it reserves with "memmap=", the log is
+ * copied out of it when the module loads and shown in /proc/bootlog.
+ */
+
+#include <linux/io.h>
+#include <linux/module.h>
+#include <linux/proc_fs.h>
+#include <linux/seq_file.h>
+#include <linux/slab.h>
+#include <linux/types.h>
+
+/* "UBLG", written by ath79_bootlog_collect() in U-Boot */
+#define BOOTLOG_MAGIC		0x55424c47
+
+struct mt02_bootlog {
+	u32 magic;
+	u32 len;
+	char data[];
+};
+
+/* Defaults match CONFIG_ATH79_BOOTLOG_ADDR/SIZE of the MT02 U-Boot */
+static ulong addr = 0x1f00000;
+module_param(addr, ulong, 0444);
+MODULE_PARM_DESC(addr, "Physical address of the U-Boot boot log area");
+
+static ulong size = 0x10000;
+module_param(size, ulong, 0444);
+MODULE_PARM_DESC(size, "Size of the U-Boot boot log area");
+
+static char *bootlog;
+static u32 bootlog_len;
+
+static int bootlog_show(struct seq_file *s, void *data)
+{
+	seq_write(s, bootlog, bootlog_len);
+	return 0;
+}
+
+static int __init mt02_bootlog_init(void)
+{
+	struct mt02_bootlog *log;
+	int ret = 0;
+
+	if (size <= sizeof(*log))
+		return -EINVAL;
+
+	log = memremap(addr, size, MEMREMAP_WB);
+	if (!log)
+		return -ENOMEM;
+
+	if (log->magic != BOOTLOG_MAGIC || log->len > size - sizeof(*log)) {
+		pr_info("mt02-bootlog: no boot log at 0x%lx\n", addr);
+		ret = -ENODEV;
+		goto out;
+	}
+
+	bootlog_len = log->len;
+	bootlog = kmemdup(log->data, bootlog_len, GFP_KERNEL);
+	if (!bootlog) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	if (!proc_create_single("bootlog", 0444, NULL, bootlog_show)) {
+		kfree(bootlog);
+		ret = -ENOMEM;
+	}
+
+out:
+	memunmap(log);
+	return ret;
+}
+
+static void __exit mt02_bootlog_exit(void)
+{
+	remove_proc_entry("bootlog", NULL);
+	kfree(bootlog);
+}
+
+module_init(mt02_bootlog_init);
+module_exit(mt02_bootlog_exit);
+
+MODULE_AUTHOR("Wojciech Cybowski");
+MODULE_DESCRIPTION("U-Boot boot log reader");
+MODULE_LICENSE("GPL");
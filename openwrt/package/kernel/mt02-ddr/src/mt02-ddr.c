@@ -0,0 +1,186 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Copyright (C) 2024 Wojciech Cybowski <github.com/wcyb>
+ *
+ * Shows what the bootloader programmed into the AR934x/QCA953x DDR
+ * controller: the raw registers, and the width, type, refresh and
+ * read DQS taps decoded from them, in debugfs under ath79-ddr/.
+ *
+ * Nothing is written to the controller: changing the taps while the
+ * CPU and the DMA masters are running could corrupt any access, so
+ * margins are left to U-Boot's ddr_tap_tuning().
+ */
+
+#include <linux/bitfield.h>
+#include <linux/bits.h>
+#include <linux/clk.h>
+#include <linux/debugfs.h>
+#include <linux/io.h>
+#include <linux/module.h>
+#include <linux/of.h>
+#include <linux/seq_file.h>
+
+#define DDR_CTRL_BASE		0x18000000
+#define DDR_CTRL_SIZE		0x160
+
+#define DDR_REG_REFRESH		0x14
+#define DDR_REG_TAP_CTRL0	0x1c
+#define DDR_REG_DDR2_CONFIG	0xb8
+#define DDR_REG_CTL_CONF	0x108
+
+#define DDR_REFRESH_EN		BIT(14)
+#define DDR_REFRESH_PERIOD	GENMASK(13, 0)
+#define DDR_DDR2_CONFIG_EN	BIT(0)
+#define DDR_CTL_CONF_HALF_WIDTH	BIT(1)
+
+struct ddr_reg {
+	const char *name;
+	u32 offset;
+};
+
+struct ddr_soc {
+	const char *name;
+	const struct ddr_reg *regs;
+	bool half_width_only;
+	unsigned int taps;
+};
+
+static const struct ddr_reg ar934x_regs[] = {
+	{ "CONFIG",		0x00 },
+	{ "CONFIG2",		0x04 },
+	{ "MODE",		0x08 },
+	{ "EMR",		0x0c },
+	{ "CONTROL",		0x10 },
+	{ "REFRESH",		0x14 },
+	{ "RD_CYCLE",		0x18 },
+	{ "TAP_CTRL0",		0x1c },
+	{ "TAP_CTRL1",		0x20 },
+	{ "TAP_CTRL2",		0x24 },
+	{ "TAP_CTRL3",		0x28 },
+	{ "DDR2_CONFIG",	0xb8 },
+	{ "EMR2",		0xbc },
+	{ "EMR3",		0xc0 },
+	{ "BURST",		0xc4 },
+	{ "BURST2",		0xc8 },
+	{ "TIMEOUT_MAX",	0xcc },
+	{ "FSM_WAIT_CTRL",	0xe4 },
+	{ "CTL_CONF",		0x108 },
+	{ }
+};
+
+static const struct ddr_reg qca953x_regs[] = {
+	{ "CONFIG",		0x00 },
+	{ "CONFIG2",		0x04 },
+	{ "MODE",		0x08 },
+	{ "EMR",		0x0c },
+	{ "CONTROL",		0x10 },
+	{ "REFRESH",		0x14 },
+	{ "RD_CYCLE",		0x18 },
+	{ "TAP_CTRL0",		0x1c },
+	{ "TAP_CTRL1",		0x20 },
+	{ "DDR2_CONFIG",	0xb8 },
+	{ "BURST",		0xc4 },
+	{ "BURST2",		0xc8 },
+	{ "TIMEOUT_MAX",	0xcc },
+	{ "CTL_CONF",		0x108 },
+	{ "CONFIG3",		0x15c },
+	{ }
+};
+
+static const struct ddr_soc ar934x_soc = {
+	.name = "AR934x",
+	.regs = ar934x_regs,
+	.taps = 4,
+};
+
+static const struct ddr_soc qca953x_soc = {
+	.name = "QCA953x",
+	.regs = qca953x_regs,
+	.half_width_only = true,
+	.taps = 2,
+};
+
+static const struct ddr_soc *soc;
+static void __iomem *ddr_base;
+static struct dentry *ddr_dir;
+
+static int ddr_regs_show(struct seq_file *s, void *data)
+{
+	const struct ddr_reg *reg;
+
+	for (reg = soc->regs; reg->name; reg++)
+		seq_printf(s, "%-14s 0x%03x 0x%08x\n", reg->name, reg->offset,
+			   __raw_readl(ddr_base + reg->offset));
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(ddr_regs);
+
+static void ddr_show_clk(struct seq_file *s, const char *name)
+{
+	struct clk *clk = clk_get(NULL, name);
+
+	if (IS_ERR(clk))
+		return;
+	seq_printf(s, "%s_clk %lu\n", name, clk_get_rate(clk));
+	clk_put(clk);
+}
+
+static int ddr_summary_show(struct seq_file *s, void *data)
+{
+	u32 refresh = __raw_readl(ddr_base + DDR_REG_REFRESH);
+	u32 ctl_conf = __raw_readl(ddr_base + DDR_REG_CTL_CONF);
+	u32 ddr2 = __raw_readl(ddr_base + DDR_REG_DDR2_CONFIG);
+	bool half = soc->half_width_only || (ctl_conf & DDR_CTL_CONF_HALF_WIDTH);
+	unsigned int i;
+
+	seq_printf(s, "soc %s\n", soc->name);
+	seq_printf(s, "type %s\n", (ddr2 & DDR_DDR2_CONFIG_EN) ? "DDR2" : "DDR1");
+	seq_printf(s, "width %u\n", half ? 16 : 32);
+	seq_printf(s, "refresh %s period %lu\n",
+		   (refresh & DDR_REFRESH_EN) ? "on" : "off",
+		   FIELD_GET(DDR_REFRESH_PERIOD, refresh));
+	/* One TAP_CTRL register per byte lane, 4 bytes apart */
+	for (i = 0; i < soc->taps; i++)
+		seq_printf(s, "tap%u %u\n", i,
+			   __raw_readl(ddr_base + DDR_REG_TAP_CTRL0 + 4 * i));
+	ddr_show_clk(s, "cpu");
+	ddr_show_clk(s, "ddr");
+	ddr_show_clk(s, "ahb");
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(ddr_summary);
+
+static int __init mt02_ddr_init(void)
+{
+	if (of_machine_is_compatible("qca,ar9341") ||
+	    of_machine_is_compatible("qca,ar9342") ||
+	    of_machine_is_compatible("qca,ar9344"))
+		soc = &ar934x_soc;
+	else if (of_machine_is_compatible("qca,qca9533"))
+		soc = &qca953x_soc;
+	else
+		return -ENODEV;
+
+	ddr_base = ioremap(DDR_CTRL_BASE, DDR_CTRL_SIZE);
+	if (!ddr_base)
+		return -ENOMEM;
+
+	ddr_dir = debugfs_create_dir("ath79-ddr", NULL);
+	debugfs_create_file("regs", 0400, ddr_dir, NULL, &ddr_regs_fops);
+	debugfs_create_file("summary", 0444, ddr_dir, NULL, &ddr_summary_fops);
+
+	return 0;
+}
+
+static void __exit mt02_ddr_exit(void)
+{
+	debugfs_remove_recursive(ddr_dir);
+	iounmap(ddr_base);
+}
+
+module_init(mt02_ddr_init);
+module_exit(mt02_ddr_exit);
+
+MODULE_AUTHOR("Wojciech Cybowski");
+MODULE_DESCRIPTION("ath79 DDR controller inspection");
+MODULE_LICENSE("GPL");
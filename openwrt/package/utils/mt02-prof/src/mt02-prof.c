@@ -0,0 +1,449 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Copyright (C) 2024 Wojciech Cybowski <github.com/wcyb>
+ *
+ * System-wide sampling profiler. Samples CPU cycles (or the cpu-clock
+ * timer when the PMU is not available) with perf_event_open, counts
+ * samples per instruction pointer and writes a compact text profile.
+ * Kernel addresses are resolved with /proc/kallsyms on the device,
+ * user addresses are written as file offsets for addr2line on a host.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#define RING_PAGES	16
+#define HASH_BITS	14
+#define HASH_SIZE	(1 << HASH_BITS)
+#define MAX_CPUS	8
+
+struct sample {
+	struct sample *next;
+	uint64_t ip;
+	uint32_t pid;
+	uint32_t kernel;
+	uint64_t count;
+};
+
+struct mapping {
+	struct mapping *next;
+	uint64_t start;
+	uint64_t end;
+	uint64_t offset;
+	char *path;
+};
+
+struct process {
+	struct process *next;
+	uint32_t pid;
+	char comm[32];
+	struct mapping *maps;
+};
+
+struct ksym {
+	uint64_t addr;
+	char *name;
+};
+
+static struct sample *samples[HASH_SIZE];
+static struct process *processes[256];
+static struct ksym *ksyms;
+static size_t nr_ksyms;
+static uint64_t total, lost;
+static volatile sig_atomic_t stop;
+
+static void on_signal(int sig)
+{
+	stop = 1;
+}
+
+static void *xcalloc(size_t n, size_t size)
+{
+	void *p = calloc(n, size);
+
+	if (!p) {
+		fprintf(stderr, "Error: out of memory\n");
+		exit(1);
+	}
+	return p;
+}
+
+static struct mapping *read_maps(uint32_t pid)
+{
+	struct mapping *head = NULL, *m;
+	char line[512], path[256], perms[8];
+	unsigned long long start, end, offset;
+	FILE *f;
+
+	snprintf(line, sizeof(line), "/proc/%u/maps", pid);
+	f = fopen(line, "r");
+	if (!f)
+		return NULL;
+
+	while (fgets(line, sizeof(line), f)) {
+		path[0] = '\0';
+		if (sscanf(line, "%llx-%llx %7s %llx %*s %*s %255s",
+			   &start, &end, perms, &offset, path) < 4)
+			continue;
+		if (perms[2] != 'x' || path[0] != '/')
+			continue;
+
+		m = xcalloc(1, sizeof(*m));
+		m->start = start;
+		m->end = end;
+		m->offset = offset;
+		m->path = strdup(path);
+		m->next = head;
+		head = m;
+	}
+
+	fclose(f);
+	return head;
+}
+
+/* Look the process up on its first sample, while it is still running */
+static struct process *get_process(uint32_t pid)
+{
+	struct process **slot = &processes[pid & 255], *p;
+	char path[32], *c;
+	FILE *f;
+
+	for (p = *slot; p; p = p->next)
+		if (p->pid == pid)
+			return p;
+
+	p = xcalloc(1, sizeof(*p));
+	p->pid = pid;
+	strcpy(p->comm, pid ? "[unknown]" : "[idle]");
+
+	snprintf(path, sizeof(path), "/proc/%u/comm", pid);
+	f = pid ? fopen(path, "r") : NULL;
+	if (f) {
+		if (fgets(p->comm, sizeof(p->comm), f))
+			p->comm[strcspn(p->comm, "\n")] = '\0';
+		fclose(f);
+	}
+	/* The profile is split on spaces */
+	for (c = p->comm; *c; c++)
+		if (*c == ' ')
+			*c = '_';
+	p->maps = pid ? read_maps(pid) : NULL;
+
+	p->next = *slot;
+	*slot = p;
+	return p;
+}
+
+static void add_sample(uint32_t pid, uint64_t ip, uint32_t kernel)
+{
+	unsigned int h = (unsigned int)((ip >> 2) ^ (pid * 2654435761u)) &
+			 (HASH_SIZE - 1);
+	struct sample *s;
+
+	total++;
+	get_process(pid);
+
+	for (s = samples[h]; s; s = s->next) {
+		if (s->ip == ip && s->pid == pid && s->kernel == kernel) {
+			s->count++;
+			return;
+		}
+	}
+
+	s = xcalloc(1, sizeof(*s));
+	s->ip = ip;
+	s->pid = pid;
+	s->kernel = kernel;
+	s->count = 1;
+	s->next = samples[h];
+	samples[h] = s;
+}
+
+static int ksym_cmp(const void *a, const void *b)
+{
+	const struct ksym *x = a, *y = b;
+
+	return x->addr < y->addr ? -1 : x->addr > y->addr;
+}
+
+static void load_kallsyms(void)
+{
+	char line[256], name[128], module[64], type;
+	unsigned long long addr;
+	size_t size = 0;
+	FILE *f;
+	int n;
+
+	f = fopen("/proc/kallsyms", "r");
+	if (!f)
+		return;
+
+	while (fgets(line, sizeof(line), f)) {
+		module[0] = '\0';
+		n = sscanf(line, "%llx %c %127s %63s", &addr, &type, name,
+			   module);
+		if (n < 3 || !addr)
+			continue;
+		if (type != 't' && type != 'T' && type != 'w' && type != 'W')
+			continue;
+
+		if (nr_ksyms == size) {
+			size = size ? size * 2 : 16384;
+			ksyms = realloc(ksyms, size * sizeof(*ksyms));
+			if (!ksyms) {
+				fprintf(stderr, "Error: out of memory\n");
+				exit(1);
+			}
+		}
+		ksyms[nr_ksyms].addr = addr;
+		if (n == 4)
+			strncat(name, module, sizeof(name) - strlen(name) - 1);
+		ksyms[nr_ksyms].name = strdup(name);
+		nr_ksyms++;
+	}
+
+	fclose(f);
+	qsort(ksyms, nr_ksyms, sizeof(*ksyms), ksym_cmp);
+}
+
+static const char *ksym_name(uint64_t ip)
+{
+	size_t lo = 0, hi = nr_ksyms;
+
+	if (!nr_ksyms || ip < ksyms[0].addr)
+		return "[kernel]";
+
+	while (hi - lo > 1) {
+		size_t mid = (lo + hi) / 2;
+
+		if (ksyms[mid].addr <= ip)
+			lo = mid;
+		else
+			hi = mid;
+	}
+	return ksyms[lo].name;
+}
+
+static int open_event(int cpu, int freq, int hardware)
+{
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = hardware ? PERF_TYPE_HARDWARE : PERF_TYPE_SOFTWARE;
+	attr.config = hardware ? PERF_COUNT_HW_CPU_CYCLES :
+				 PERF_COUNT_SW_CPU_CLOCK;
+	attr.freq = 1;
+	attr.sample_freq = freq;
+	attr.sample_type = PERF_SAMPLE_IP | PERF_SAMPLE_TID;
+	attr.exclude_hv = 1;
+	attr.disabled = 1;
+	attr.wakeup_events = 64;
+
+	return syscall(SYS_perf_event_open, &attr, -1, cpu, -1, 0);
+}
+
+static void read_ring(struct perf_event_mmap_page *meta, long page_size)
+{
+	uint8_t *data = (uint8_t *)meta + page_size;
+	uint64_t size = (uint64_t)RING_PAGES * page_size;
+	uint64_t head = meta->data_head, tail = meta->data_tail;
+	uint8_t record[64];
+
+	__sync_synchronize();
+
+	while (tail < head) {
+		struct perf_event_header *hdr = (void *)record;
+		uint64_t i, len;
+
+		/* Records may wrap around the end of the ring */
+		for (i = 0; i < sizeof(*hdr); i++)
+			record[i] = data[(tail + i) % size];
+		len = hdr->size;
+		if (len < sizeof(*hdr))
+			break;
+		for (i = sizeof(*hdr); i < len && i < sizeof(record); i++)
+			record[i] = data[(tail + i) % size];
+
+		if (hdr->type == PERF_RECORD_SAMPLE) {
+			uint64_t ip;
+			uint32_t pid;
+
+			memcpy(&ip, record + sizeof(*hdr), sizeof(ip));
+			memcpy(&pid, record + sizeof(*hdr) + sizeof(ip),
+			       sizeof(pid));
+			add_sample(pid, ip,
+				   (hdr->misc & PERF_RECORD_MISC_CPUMODE_MASK) ==
+				   PERF_RECORD_MISC_KERNEL);
+		} else if (hdr->type == PERF_RECORD_LOST) {
+			uint64_t count;
+
+			memcpy(&count, record + sizeof(*hdr) + sizeof(uint64_t),
+			       sizeof(count));
+			lost += count;
+		}
+		tail += len;
+	}
+
+	__sync_synchronize();
+	meta->data_tail = tail;
+}
+
+static void write_profile(FILE *out, const char *event, int freq,
+			  double seconds)
+{
+	struct sample *s;
+	struct process *p;
+	struct mapping *m;
+	unsigned int i;
+
+	fprintf(out, "mt02-prof 1 %s %d %.1f %" PRIu64 " %" PRIu64 "\n",
+		event, freq, seconds, total, lost);
+
+	for (i = 0; i < HASH_SIZE; i++) {
+		for (s = samples[i]; s; s = s->next) {
+			p = get_process(s->pid);
+			if (s->kernel) {
+				fprintf(out, "k %" PRIu64 " %s %s\n", s->count,
+					p->comm, ksym_name(s->ip));
+				continue;
+			}
+
+			for (m = p->maps; m; m = m->next)
+				if (s->ip >= m->start && s->ip < m->end)
+					break;
+			if (m)
+				fprintf(out, "u %" PRIu64 " %s %s %" PRIx64 "\n",
+					s->count, p->comm, m->path,
+					s->ip - m->start + m->offset);
+			else
+				fprintf(out, "u %" PRIu64 " %s [unknown] %" PRIx64 "\n",
+					s->count, p->comm, s->ip);
+		}
+	}
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr,
+		"Usage: %s [-h] [-F frequency] [-d seconds] [-o file]\n"
+		"Sample all processes and the kernel, and write a profile for analyze_profile.sh.\n"
+		"Options:\n"
+		"  -h            Display this help message and exit.\n"
+		"  -F FREQUENCY  Samples per second (default 1000).\n"
+		"  -d SECONDS    Duration, or until interrupted (default 10).\n"
+		"  -o FILE       Output file (default stdout).\n",
+		name);
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	struct perf_event_mmap_page *rings[MAX_CPUS];
+	struct pollfd fds[MAX_CPUS];
+	long page_size = sysconf(_SC_PAGESIZE);
+	int cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	int freq = 1000, duration = 10, hardware = 1;
+	const char *output = NULL;
+	struct timespec begin, end;
+	FILE *out = stdout;
+	int cpu, opt;
+
+	while ((opt = getopt(argc, argv, "hF:d:o:")) != -1) {
+		switch (opt) {
+		case 'F':
+			freq = atoi(optarg);
+			break;
+		case 'd':
+			duration = atoi(optarg);
+			break;
+		case 'o':
+			output = optarg;
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (freq <= 0 || duration <= 0)
+		usage(argv[0]);
+	if (cpus > MAX_CPUS)
+		cpus = MAX_CPUS;
+
+	for (cpu = 0; cpu < cpus; cpu++) {
+		fds[cpu].fd = open_event(cpu, freq, hardware);
+		if (fds[cpu].fd < 0 && hardware && cpu == 0) {
+			fprintf(stderr, "No PMU (%s), sampling cpu-clock instead\n",
+				strerror(errno));
+			hardware = 0;
+			fds[cpu].fd = open_event(cpu, freq, hardware);
+		}
+		if (fds[cpu].fd < 0) {
+			fprintf(stderr, "Error: perf_event_open failed on CPU %d: %s\n",
+				cpu, strerror(errno));
+			return 1;
+		}
+		fds[cpu].events = POLLIN;
+
+		rings[cpu] = mmap(NULL, (RING_PAGES + 1) * page_size,
+				  PROT_READ | PROT_WRITE, MAP_SHARED,
+				  fds[cpu].fd, 0);
+		if (rings[cpu] == MAP_FAILED) {
+			fprintf(stderr, "Error: mmap failed: %s\n",
+				strerror(errno));
+			return 1;
+		}
+	}
+
+	load_kallsyms();
+	signal(SIGINT, on_signal);
+	signal(SIGTERM, on_signal);
+	signal(SIGALRM, on_signal);
+	alarm(duration);
+
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+	for (cpu = 0; cpu < cpus; cpu++)
+		ioctl(fds[cpu].fd, PERF_EVENT_IOC_ENABLE, 0);
+
+	while (!stop) {
+		poll(fds, cpus, 100);
+		for (cpu = 0; cpu < cpus; cpu++)
+			read_ring(rings[cpu], page_size);
+	}
+
+	for (cpu = 0; cpu < cpus; cpu++) {
+		ioctl(fds[cpu].fd, PERF_EVENT_IOC_DISABLE, 0);
+		read_ring(rings[cpu], page_size);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	if (output) {
+		out = fopen(output, "w");
+		if (!out) {
+			fprintf(stderr, "Error: cannot open %s: %s\n", output,
+				strerror(errno));
+			return 1;
+		}
+	}
+
+	write_profile(out, hardware ? "cycles" : "cpu-clock", freq,
+		      (end.tv_sec - begin.tv_sec) +
+		      (end.tv_nsec - begin.tv_nsec) / 1e9);
+
+	if (out != stdout)
+		fclose(out);
+	fprintf(stderr, "%" PRIu64 " samples, %" PRIu64 " lost\n", total, lost);
+	return 0;
+}
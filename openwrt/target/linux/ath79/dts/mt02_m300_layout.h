@@ -0,0 +1,29 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+/*
+ * MT02 M300 SPI flash layout.
+ *
+ * Shared by the DTS partition nodes and combine_files.sh. Keep offsets
+ * and sizes plain hex constants so the script can read them as well,
+ * the firmware partition takes whatever is left up to MT02_FLASH_SIZE.
+ */
+
+#ifndef __MT02_M300_LAYOUT_H
+#define __MT02_M300_LAYOUT_H
+
+#ifndef MT02_FLASH_SIZE
+#define MT02_FLASH_SIZE		0x1000000
+#endif
+
+#define MT02_UBOOT_OFFSET	0x000000
+#define MT02_UBOOT_SIZE		0x050000
+
+#define MT02_ENV_OFFSET		0x050000
+#define MT02_ENV_SIZE		0x010000
+
+#define MT02_ART_OFFSET		0x060000
+#define MT02_ART_SIZE		0x010000
+
+#define MT02_FIRMWARE_OFFSET	0x070000
+#define MT02_FIRMWARE_SIZE	(MT02_FLASH_SIZE - MT02_FIRMWARE_OFFSET)
+
+#endif /* __MT02_M300_LAYOUT_H */
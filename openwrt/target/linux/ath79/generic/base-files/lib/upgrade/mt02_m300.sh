@@ -0,0 +1,121 @@
+#
+# Copyright (C) 2024 Wojciech Cybowski <github.com/wcyb>
+#
+# Delta upgrade for the MT02 M300: compare the new firmware with the
+# flash contents one erase block at a time and rewrite only the blocks
+# that differ. At 25 MHz SPI most of the sysupgrade time goes into
+# erasing and programming, reading back is cheap in comparison.
+#
+# Crash safety: the first block holds the uImage header, it is erased
+# before any other block is touched and written back last. An upgrade
+# interrupted in between leaves an image that U-Boot refuses to boot,
+# never a mix of the old and the new firmware, just like a full write.
+#
+
+MT02_BLOCK_SIZE=65536
+
+mt02_full_upgrade() {
+	if [ -n "$UPGRADE_BACKUP" ]; then
+		get_image "$1" "$2" | mtd $MTD_ARGS $MTD_CONFIG_ARGS -j "$UPGRADE_BACKUP" write - "${PART_NAME:-firmware}"
+	else
+		get_image "$1" "$2" | mtd $MTD_ARGS write - "${PART_NAME:-firmware}"
+	fi
+}
+
+# Print the md5 sum of one erase block of a file or mtd device
+mt02_block_md5() {
+	dd if="$1" bs=$MT02_BLOCK_SIZE skip="$2" count=1 2>/dev/null | md5sum | cut -d' ' -f1
+}
+
+# Write blocks [first, last] of the image at the same offset of the partition
+mt02_write_blocks() {
+	local image="$1" first="$2" last="$3" jffs2="$4"
+	local args="$MTD_ARGS -p $((first * MT02_BLOCK_SIZE))"
+
+	[ -n "$jffs2" ] && args="$args $MTD_CONFIG_ARGS -j $jffs2"
+	dd if="$image" bs=$MT02_BLOCK_SIZE skip="$first" count=$((last - first + 1)) 2>/dev/null | \
+		mtd $args write - "${PART_NAME:-firmware}"
+}
+
+mt02_delta_upgrade() {
+	local image="$1" cmd="$2"
+	local mtdidx size blocks tail i run last changed=0
+
+	# Compressed images would have to be unpacked to RAM first. ath79
+	# passes no command, get_image only picks zcat from the gzip magic,
+	# so look at the magic here as well
+	[ -z "$cmd" ] || [ "$cmd" = "cat" ] || return 1
+	[ -f "$image" ] || return 1
+	[ "$(hexdump -v -n 2 -e '2/1 "%02x"' "$image")" != "1f8b" ] || return 1
+
+	mtdidx=$(find_mtd_index "${PART_NAME:-firmware}")
+	[ -n "$mtdidx" ] || return 1
+
+	size=$(wc -c < "$image")
+	[ "$size" -gt $MT02_BLOCK_SIZE ] || return 1
+
+	# The last (possibly partial) block carries the rootfs_data marker,
+	# it is always written so mtd can handle the config backup there
+	tail=$(((size - 1) / MT02_BLOCK_SIZE))
+	blocks=""
+	i=1
+	while [ $i -lt $tail ]; do
+		if [ "$(mt02_block_md5 "$image" $i)" != "$(mt02_block_md5 /dev/mtd$mtdidx $i)" ]; then
+			blocks="$blocks $i"
+			changed=$((changed + 1))
+		fi
+		i=$((i + 1))
+	done
+	v "Delta upgrade: $changed of $((tail + 1)) blocks changed"
+
+	# Invalidate the uImage header first
+	head -c $MT02_BLOCK_SIZE /dev/zero | tr '\000' '\377' | \
+		mtd $MTD_ARGS -p 0 write - "${PART_NAME:-firmware}" || return 2
+
+	# Coalesce consecutive blocks into a single mtd call
+	run=""
+	for i in $blocks; do
+		if [ -n "$run" ] && [ "$i" -eq $((last + 1)) ]; then
+			last=$i
+			continue
+		fi
+		[ -n "$run" ] && { mt02_write_blocks "$image" $run $last || return 2; }
+		run=$i
+		last=$i
+	done
+	[ -n "$run" ] && { mt02_write_blocks "$image" $run $last || return 2; }
+
+	mt02_write_blocks "$image" $tail $tail "$UPGRADE_BACKUP" || return 2
+	mt02_write_blocks "$image" 0 0 || return 2
+
+	return 0
+}
+
+mt02_do_upgrade() {
+	sync
+	echo 3 > /proc/sys/vm/drop_caches
+
+	mt02_delta_upgrade "$1" "$2"
+	case $? in
+	0)
+		;;
+	1)
+		v "Delta upgrade not possible, writing the whole image"
+		mt02_full_upgrade "$1" "$2" || exit 1
+		;;
+	*)
+		exit 1
+		;;
+	esac
+}
+
+case "$(board_name)" in
+generic,mt02_m300-mt9341|\
+generic,mt02_m300-mt9341-32m|\
+generic,mt02_m300-mt9533|\
+generic,mt02_m300-mt9533-32m)
+	default_do_upgrade() {
+		mt02_do_upgrade "$1" "$2"
+	}
+	;;
+esac
@@ -3424,23 +3424,41 @@ define Device/mt02_m300-mt9533
   SOC := qca9533
   DEVICE_MODEL := MT02 M300
   DEVICE_VARIANT := MT9533
+  DEVICE_PACKAGES := relayd kmod-mt02-ddr kmod-mt02-bootlog mt02-defaults-mt9533
   IMAGE_SIZE := 16000k
   LOADER_TYPE := bin
-  KERNEL := kernel-bin | append-dtb | lzma | loader-kernel | uImage none
+  KERNEL := kernel-bin | append-dtb | lzma | uImage lzma
   KERNEL_INITRAMFS := kernel-bin | append-dtb | lzma | loader-kernel | uImage none
   SUPPORTED_DEVICES := generic,mt02_m300-mt9533
 endef
 TARGET_DEVICES += mt02_m300-mt9533
 
+define Device/mt02_m300-mt9533-32m
+  $(Device/mt02_m300-mt9533)
+  DEVICE_VARIANT := MT9533 (32M)
+  IMAGE_SIZE := 32320k
+  SUPPORTED_DEVICES := generic,mt02_m300-mt9533-32m
+endef
+TARGET_DEVICES += mt02_m300-mt9533-32m
+
 define Device/mt02_m300-mt9341
   $(Device/Default)
   SOC := ar9341
   DEVICE_MODEL := MT02 M300
   DEVICE_VARIANT := MT9341
+  DEVICE_PACKAGES := relayd kmod-mt02-ddr kmod-mt02-bootlog mt02-defaults-mt9341
   IMAGE_SIZE := 16000k
   LOADER_TYPE := bin
-  KERNEL := kernel-bin | append-dtb | lzma | loader-kernel | uImage none
+  KERNEL := kernel-bin | append-dtb | lzma | uImage lzma
   KERNEL_INITRAMFS := kernel-bin | append-dtb | lzma | loader-kernel | uImage none
   SUPPORTED_DEVICES := generic,mt02_m300-mt9341
 endef
 TARGET_DEVICES += mt02_m300-mt9341
+
+define Device/mt02_m300-mt9341-32m
+  $(Device/mt02_m300-mt9341)
+  DEVICE_VARIANT := MT9341 (32M)
+  IMAGE_SIZE := 32320k
+  SUPPORTED_DEVICES := generic,mt02_m300-mt9341-32m
+endef
+TARGET_DEVICES += mt02_m300-mt9341-32m
@@ -11,8 +11,10 @@
 #include <asm/types.h>
 #include <linux/bitops.h>
 #include <linux/delay.h>
+#include <linux/kernel.h>
 #include <mach/ar71xx_regs.h>
 #include <mach/ath79.h>
+#include <mach/ddr.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -47,63 +49,9 @@ DECLARE_GLOBAL_DATA_PTR;
 #define DDR1_timing_clk_max	400
 #define DDR2_timing_clk_max	533
 
-/* Maximum timing values, based on register fields sizes */
-#define MAX_tFAW	BITS(0, 6)
-#define MAX_tMRD	BITS(0, 4)
-#define MAX_tRAS	BITS(0, 5)
-#define MAX_tRCD	BITS(0, 4)
-#define MAX_tRFC	BITS(0, 6)
-#define MAX_tRP		BITS(0, 4)
-#define MAX_tRRD	BITS(0, 4)
-#define MAX_tRTP	BITS(0, 4)
-#define MAX_tRTW	BITS(0, 5)
-#define MAX_tWL		BITS(0, 4)
-#define MAX_tWR		BITS(0, 4)
-#define MAX_tWTR	BITS(0, 5)
-
-#define DDR_CTL_HALF_WIDTH				BIT(1)
-#define DDR_CTL_SRAM_REQ_ACK			BIT(3)
-#define CPU_PLL_DITHER_NFRAC_MIN_SHIFT	6
-#define CPU_PLL_DITHER_NFRAC_MIN_MASK	BITS(CPU_PLL_DITHER_NFRAC_MIN_SHIFT, 6)
-#define DDR_PLL_DITHER_NFRAC_MIN_SHIFT	10
-#define DDR_PLL_DITHER_NFRAC_MIN_MASK	BITS(DDR_PLL_DITHER_NFRAC_MIN_SHIFT, 10)
-#define DDR_CTRL_CFG_CPU_DDR_SYNC_MASK	BIT(2)
-#define DDR_CTRL_CFG_PAD_DDR2_SEL_MASK	BIT(6)
-#define DDR_DDR2_CFG_DDR2_EN_MASK		BIT(0)
-#define DDR_DDR2_CFG_DDR2_TFAW_SHIFT	2
-#define DDR_DDR2_CFG_DDR2_TFAW_MASK		BITS(DDR_DDR2_CFG_DDR2_TFAW_SHIFT, 6)
-#define DDR_DDR2_CFG_DDR2_TWL_SHIFT		10
-#define DDR_DDR2_CFG_DDR2_TWL_MASK		BITS(DDR_DDR2_CFG_DDR2_TWL_SHIFT, 4)
-#define DDR_CFG_PAGE_CLOSE_MASK			BIT(30)
-#define DDR_CFG_CAS_3LSB_SHIFT			27
-#define DDR_CFG_CAS_3LSB_MASK			BITS(DDR_CFG_CAS_3LSB_SHIFT, 3)
-#define DDR_CFG_CAS_MSB_MASK			BIT(31)
-#define DDR_CFG_TMRD_SHIFT				23
-#define DDR_CFG_TMRD_MASK				BITS(DDR_CFG_TMRD_SHIFT, 4)
-#define DDR_CFG_TRFC_SHIFT				17
-#define DDR_CFG_TRFC_MASK				BITS(DDR_CFG_TRFC_SHIFT, 6)
-#define DDR_CFG_TRRD_SHIFT				13
-#define DDR_CFG_TRRD_MASK				BITS(DDR_CFG_TRRD_SHIFT, 4)
-#define DDR_CFG_TRP_SHIFT				9
-#define DDR_CFG_TRP_MASK				BITS(DDR_CFG_TRP_SHIFT, 4)
-#define DDR_CFG_TRCD_SHIFT				5
-#define DDR_CFG_TRCD_MASK				BITS(DDR_CFG_TRCD_SHIFT, 4)
-#define DDR_CFG_TRAS_SHIFT				0
-#define DDR_CFG_TRAS_MASK				BITS(DDR_CFG_TRAS_SHIFT, 5)
-#define DDR_CFG2_CKE_MASK				BIT(7)
-#define DDR_CFG2_GATE_OPEN_LAT_SHIFT	26
-#define DDR_CFG2_GATE_OPEN_LAT_MASK		BITS(DDR_CFG2_GATE_OPEN_LAT_SHIFT, 4)
-#define DDR_CFG2_TWTR_SHIFT				21
-#define DDR_CFG2_TWTR_MASK				BITS(DDR_CFG2_TWTR_SHIFT, 5)
-#define DDR_CFG2_TRTP_SHIFT				17
-#define DDR_CFG2_TRTP_MASK				BITS(DDR_CFG2_TRTP_SHIFT, 4)
-#define DDR_CFG2_TRTW_SHIFT				12
-#define DDR_CFG2_TRTW_MASK				BITS(DDR_CFG2_TRTW_SHIFT, 5)
-#define DDR_CFG2_TWR_SHIFT				8
-#define DDR_CFG2_TWR_MASK				BITS(DDR_CFG2_TWR_SHIFT, 4)
-#define DDR_CFG2_BURST_LEN_SHIFT		0
-#define DDR_CFG2_BURST_LEN_MASK			BITS(DDR_CFG2_BURST_LEN_SHIFT, 4)
-#define DDR_CFG2_BURST_TYPE_MASK		BIT(4)
+/* Scratch area used for data lane probing, below the tap tuning pattern */
+#define DDR_PROBE_ADDR	0x1000
+
 #define DDR_CTRL_FORCE_PRECHRG_ALL_MASK BIT(3)
 #define DDR_CTRL_FORCE_EMR2S_MASK		BIT(4)
 #define DDR_CTRL_FORCE_EMR3S_MASK		BIT(5)
@@ -111,12 +59,6 @@ DECLARE_GLOBAL_DATA_PTR;
 #define DDR_CTRL_FORCE_EMRS_MASK		BIT(1)
 #define DDR_CTRL_FORCE_MRS_MASK			BIT(0)
 
-#define ath79_reg_read_set(_addr, _mask)	\
-		writel((readl((_addr)) | (_mask)), (_addr))
-
-#define ath79_reg_read_clear(_addr, _mask)	\
-		writel((readl((_addr)) & ~(_mask)), (_addr))
-
 /* Prepare DDR SDRAM extended mode register 2 value */
 #define DDR_SDRAM_EMR2_PASR_SHIFT	0
 #define DDR_SDRAM_EMR2_PASR_MASK	BITS(DDR_SDRAM_EMR2_PASR_SHIFT, 3)
@@ -188,274 +130,153 @@ DECLARE_GLOBAL_DATA_PTR;
 	((_dll_res       << DDR_SDRAM_MR_DLL_RESET_SHIFT)   & DDR_SDRAM_MR_DLL_RESET_MASK)   |\
 	(((_wr_rcov - 1) << DDR_SDRAM_MR_WR_RECOVERY_SHIFT) & DDR_SDRAM_MR_WR_RECOVERY_MASK) |\
 	((_burst_i       << DDR_SDRAM_MR_BURST_INTERLEAVE_SHIFT) & DDR_SDRAM_MR_BURST_INTERLEAVE_MASK)
-
 enum {
 	AR934X_SDRAM = 0,
 	AR934X_DDR1,
 	AR934X_DDR2,
 };
 
-void ar934x_ddr_init(const u16 cpu_mhz, const u16 ddr_mhz, const u16 ahb_mhz)
-{
-	void __iomem *ddr_regs;
-	void __iomem *pll_regs;
-	u32 mem_type, tmp_clk;
-	u32 cas_lat, ddr_width, reg, tmp, wr_recovery;
-
-	ddr_regs = map_physmem(AR71XX_DDR_CTRL_BASE, AR71XX_DDR_CTRL_SIZE,
-			       MAP_NOCACHE);
+/*
+ * Shadow copies of the controller configuration registers.
+ * All values are composed here first and then written to the
+ * controller once, in the order the hardware expects them.
+ */
+struct ar934x_ddr_shadow {
+	u32 ctl_conf;
+	u32 rd_cycle;
+	u32 fsm_wait_ctrl;
+	u32 ddr2_config;
+	u32 config;
+	u32 config2;
+};
 
-	reg = ath79_get_bootstrap();
-	if (reg & AR934X_BOOTSTRAP_SDRAM_DISABLED) {	/* DDR */
-		if (reg & AR934X_BOOTSTRAP_DDR1) {	/* DDR 1 */
-			mem_type = AR934X_DDR1;
-		} else {				/* DDR 2 */
-			mem_type = AR934X_DDR2;
-		}
-	} else {					/* SDRAM */
-		mem_type = AR934X_SDRAM;
-	}
+/* Convert time in ns to DDR clock cycles, rounded to closest integer */
+static inline u32 ddr_ns_to_clk(u32 ns, u32 ddr_mhz)
+{
+	return ((ns * ddr_mhz) + 500) / 1000;
+}
 
-	/* Set CAS based on clock, but allow to set static value */
-#ifndef CONFIG_BOARD_DRAM_CAS_LATENCY
-	if (mem_type == AR934X_DDR1) {
-		if (ddr_mhz <= 266) {
-			cas_lat = 2;
-		} else {
-			cas_lat = 3;
-		}
-	} else if (mem_type == AR934X_DDR2) {
-		if (ddr_mhz <= 400) {
-			cas_lat = 3;
-		} else if (ddr_mhz <= 533) {
-			cas_lat = 4;
-		} else if (ddr_mhz <= 666) {
-			cas_lat = 5;
-		} else if (ddr_mhz <= 800) {
-			cas_lat = 6;
-		} else {
-			cas_lat = 7;
-		}
-	} else { /* SDRAM */
+/* Apply bus width dependent settings */
+static void ar934x_ddr_shadow_set_width(struct ar934x_ddr_shadow *s,
+					u32 ddr_width)
+{
+	u32 trtp;
 
+	/* For 32-bit clear HALF_WIDTH and set VEC = 0xFF */
+	if (ddr_width == 32) {
+		s->ctl_conf &= ~AR934X_DDR_CTL_CONF_HALF_WIDTH;
+		s->rd_cycle = 0xFF;
+		trtp = DDR_burst_len;
+	} else {
+		s->ctl_conf |= AR934X_DDR_CTL_CONF_HALF_WIDTH;
+		s->rd_cycle = 0xFFFF;
+		trtp = AR934X_DDR_CONFIG2_TRTP_MASK;
 	}
-#else
-	cas_lat = CONFIG_BOARD_DRAM_CAS_LATENCY;
-#endif
 
-	/* AR933x supports only 16-bit memory */
-	/* For other WiSoCs we can determine DDR width, based on bootstrap */
-#ifndef CONFIG_BOARD_DRAM_DDR_WIDTH
-	if (reg & BIT(3))
-		ddr_width = 32;
-	else
-		ddr_width = 16;
-#else
-	ddr_width = CONFIG_BOARD_DRAM_DDR_WIDTH;
+#ifndef CONFIG_ATH79_DDR_CFG2_REG_VAL
+	s->config2 = ATH79_FIELD_SET(s->config2, AR934X_DDR_CONFIG2_TRTP, trtp);
 #endif
+}
 
-	if (ddr_width == 32) {
-		/* For 32-bit clear HALF_WIDTH and set VEC = 0xFF */
-		ath79_reg_read_clear(ddr_regs + AR934X_DDR_REG_CTL_CONF,
-						DDR_CTL_HALF_WIDTH);
-		
-		writel(0xFF, ddr_regs + AR71XX_DDR_REG_RD_CYCLE);
-	} else {
-		ath79_reg_read_set(ddr_regs + AR934X_DDR_REG_CTL_CONF,
-						DDR_CTL_HALF_WIDTH);
-
-		writel(0xFFFF, ddr_regs + AR71XX_DDR_REG_RD_CYCLE);
-	}
+/*
+ * Compose the target register values from the current (reset) ones.
+ * This does not touch the hardware, so the result for a given set of
+ * parameters can be checked without a board.
+ */
+static void ar934x_ddr_shadow_compose(struct ar934x_ddr_shadow *s,
+				      u32 mem_type, u32 cas_lat, u32 ddr_width,
+				      const u16 cpu_mhz, const u16 ddr_mhz,
+				      const u16 ahb_mhz, bool fractional)
+{
+	u32 reg, tmp;
 
 	/* If DDR_MHZ < 2 * AHB_MHZ, set DDR FSM wait control to 0xA24 */
+	s->fsm_wait_ctrl = 0;
 	if (ddr_mhz < (2 * ahb_mhz))
-		writel(0xA24, ddr_regs + AR934X_DDR_REG_FSM_WAIT_CTRL);
+		s->fsm_wait_ctrl = 0xA24;
 
 	/* If CPU clock < AHB clock, set SRAM REQ ACK */
 	if (cpu_mhz < ahb_mhz)
-		ath79_reg_read_set(ddr_regs + AR934X_DDR_REG_CTL_CONF,
-						DDR_CTL_SRAM_REQ_ACK);
+		s->ctl_conf |= AR934X_DDR_CTL_CONF_SRAM_REQ_ACK;
 	else
-		ath79_reg_read_clear(ddr_regs + AR934X_DDR_REG_CTL_CONF,
-						DDR_CTL_SRAM_REQ_ACK);
+		s->ctl_conf &= ~AR934X_DDR_CTL_CONF_SRAM_REQ_ACK;
 
 	/*
 	 * CPU/DDR sync mode only when we don't use
 	 * fractional multipliers in PLL/clocks config
 	 */
-	tmp = 0;
-
-	pll_regs = map_physmem(AR71XX_PLL_BASE, AR71XX_PLL_SIZE,
-			       MAP_NOCACHE);
-
-	reg = readl(pll_regs + AR934X_PLL_CPU_DIT_FRAC_REG);
-	reg = (reg & CPU_PLL_DITHER_NFRAC_MIN_MASK)
-	    	>> CPU_PLL_DITHER_NFRAC_MIN_SHIFT;
-
-	if (reg)
-		tmp = 1;
-
-	reg = readl(pll_regs + AR934X_PLL_DDR_DIT_FRAC_REG);
-	reg = (reg & DDR_PLL_DITHER_NFRAC_MIN_MASK)
-	    	>> DDR_PLL_DITHER_NFRAC_MIN_SHIFT;
-
-	if (reg)
-		tmp = 1;
-
-	if (!tmp && (cpu_mhz == ddr_mhz)) {
-		ath79_reg_read_set(ddr_regs + AR934X_DDR_REG_CTL_CONF,
-						DDR_CTRL_CFG_CPU_DDR_SYNC_MASK);
-	} else {
-		ath79_reg_read_clear(ddr_regs + AR934X_DDR_REG_CTL_CONF,
-						DDR_CTRL_CFG_CPU_DDR_SYNC_MASK);
-	}
-
-	/* Check if clock is not too low for our "safe" timing values */
-	tmp_clk = ddr_mhz;
-	if (mem_type == AR934X_DDR1) {
-		if (tmp_clk < DDR1_timing_clk_max)
-			tmp_clk = DDR1_timing_clk_max;
-	} else if (mem_type == AR934X_DDR2) {
-		if (tmp_clk < DDR2_timing_clk_max)
-			tmp_clk = DDR2_timing_clk_max;
-	} else { /* SDRAM */
-
-	}
+	if (!fractional && (cpu_mhz == ddr_mhz))
+		s->ctl_conf |= AR934X_DDR_CTL_CONF_CPU_DDR_SYNC;
+	else
+		s->ctl_conf &= ~AR934X_DDR_CTL_CONF_CPU_DDR_SYNC;
 
 	/* Enable DDR2 */
 	if (mem_type == AR934X_DDR2) {
-		ath79_reg_read_set(ddr_regs + AR934X_DDR_REG_CTL_CONF,
-						DDR_CTRL_CFG_PAD_DDR2_SEL_MASK);
+		s->ctl_conf |= AR934X_DDR_CTL_CONF_PAD_DDR2_SEL;
 #ifndef CONFIG_ATH79_DDR_DDR2_CFG_REG_VAL
-	reg = readl(ddr_regs + AR934X_DDR_REG_DDR2_CONFIG);
+		reg = s->ddr2_config | AR934X_DDR_DDR2_CONFIG_EN;
 
-	/* Enable DDR2 */
-	reg = reg | DDR_DDR2_CFG_DDR2_EN_MASK;
-
-	/* tFAW */
-	tmp = ((DDR2_tFAW_ns * ddr_mhz) + 500) / 1000;
-	if (tmp > MAX_tFAW)
-		tmp = MAX_tFAW;
-
-	tmp = (tmp << DDR_DDR2_CFG_DDR2_TFAW_SHIFT)
-	      & DDR_DDR2_CFG_DDR2_TFAW_MASK;
-	reg = reg & ~DDR_DDR2_CFG_DDR2_TFAW_MASK;
-	reg = reg | tmp;
-
-	/* tWL */
-	tmp = (2 * cas_lat) - 3;
-	tmp = (tmp << DDR_DDR2_CFG_DDR2_TWL_SHIFT)
-	      & DDR_DDR2_CFG_DDR2_TWL_MASK;
-	reg = reg & ~DDR_DDR2_CFG_DDR2_TWL_MASK;
-	reg = reg | tmp;
-
-	writel(reg, ddr_regs + AR934X_DDR_REG_DDR2_CONFIG);
+		/* tFAW */
+		reg = ATH79_FIELD_SET(reg, AR934X_DDR_DDR2_CONFIG_TFAW,
+				      ddr_ns_to_clk(DDR2_tFAW_ns, ddr_mhz));
+
+		/* tWL */
+		reg = ATH79_FIELD_SET(reg, AR934X_DDR_DDR2_CONFIG_TWL,
+				      (2 * cas_lat) - 3);
+
+		s->ddr2_config = reg;
 #else
-	writel(CONFIG_ATH79_DDR_DDR2_CFG_REG_VAL,
-					ddr_regs + AR934X_DDR_REG_DDR2_CONFIG);
+		s->ddr2_config = CONFIG_ATH79_DDR_DDR2_CFG_REG_VAL;
 #endif
 	} else {
-		ath79_reg_read_clear(ddr_regs + AR934X_DDR_REG_CTL_CONF,
-						DDR_CTRL_CFG_PAD_DDR2_SEL_MASK);
+		s->ctl_conf &= ~AR934X_DDR_CTL_CONF_PAD_DDR2_SEL;
 	}
 
 	/* Setup DDR timing related registers */
 #ifndef CONFIG_ATH79_DDR_CFG_REG_VAL
-	reg = readl(ddr_regs);
-
 	/* Always use page close policy */
-	reg = reg | DDR_CFG_PAGE_CLOSE_MASK;
+	reg = s->config | AR934X_DDR_CONFIG_PAGE_CLOSE;
 
 	/* CAS should be (2 * CAS_LAT) or (2 * CAS_LAT) + 1/2/3 */
-	tmp = 2 * cas_lat;
-	tmp = (tmp << DDR_CFG_CAS_3LSB_SHIFT) & DDR_CFG_CAS_3LSB_MASK;
-	if (cas_lat > 3) {
-		tmp = tmp | DDR_CFG_CAS_MSB_MASK;
-	}
-
-	reg = reg & ~DDR_CFG_CAS_3LSB_MASK;
-	reg = reg | tmp;
+	reg = ATH79_FIELD_SET(reg, AR934X_DDR_CONFIG_CAS_3LSB,
+			      (2 * cas_lat) & AR934X_DDR_CONFIG_CAS_3LSB_MASK);
+	if (cas_lat > 3)
+		reg |= AR934X_DDR_CONFIG_CAS_MSB;
 
 	/*
 	 * Calculate rest of timing related values,
 	 * always round up to closest integer
 	 */
+	reg = ATH79_FIELD_SET(reg, AR934X_DDR_CONFIG_TMRD,
+			      ddr_ns_to_clk(DDRx_tMRD_ns, ddr_mhz));
 
-	/* tMRD */
-	tmp = ((DDRx_tMRD_ns * ddr_mhz) + 500) / 1000;
-	if (tmp > MAX_tMRD)
-		tmp = MAX_tMRD;
-
-	tmp = (tmp << DDR_CFG_TMRD_SHIFT) & DDR_CFG_TMRD_MASK;
-	reg = reg & ~DDR_CFG_TMRD_MASK;
-	reg = reg | tmp;
-
-	/* tRFC */
-	if (mem_type == AR934X_DDR2) {
-		tmp = ((DDR2_tRFC_ns * ddr_mhz) + 500) / 1000;
-	} else {
-		tmp = ((DDR1_tRFC_ns * ddr_mhz) + 500) / 1000;
-	}
-
-	if (tmp > MAX_tRFC)
-		tmp = MAX_tRFC;
-
-	tmp = (tmp << DDR_CFG_TRFC_SHIFT) & DDR_CFG_TRFC_MASK;
-	reg = reg & ~DDR_CFG_TRFC_MASK;
-	reg = reg | tmp;
-
-	/* tRRD */
-	tmp = ((DDRx_tRRD_ns * ddr_mhz) + 500) / 1000;
-	if (tmp > MAX_tRRD)
-		tmp = MAX_tRRD;
-
-	tmp = (tmp << DDR_CFG_TRRD_SHIFT) & DDR_CFG_TRRD_MASK;
-	reg = reg & ~DDR_CFG_TRRD_MASK;
-	reg = reg | tmp;
-
-	/* tRP */
-	tmp = ((DDRx_tRP_ns * ddr_mhz) + 500) / 1000;
-	if (tmp > MAX_tRP)
-		tmp = MAX_tRP;
-
-	tmp = (tmp << DDR_CFG_TRP_SHIFT) & DDR_CFG_TRP_MASK;
-	reg = reg & ~DDR_CFG_TRP_MASK;
-	reg = reg | tmp;
-
-	/* tRCD */
-	tmp = ((DDRx_tRCD_ns * ddr_mhz) + 500) / 1000;
-	if (tmp > MAX_tRCD)
-		tmp = MAX_tRCD;
-
-	tmp = (tmp << DDR_CFG_TRCD_SHIFT) & DDR_CFG_TRCD_MASK;
-	reg = reg & ~DDR_CFG_TRCD_MASK;
-	reg = reg | tmp;
-
-	/* tRAS */
-	tmp = ((DDRx_tRAS_ns * ddr_mhz) + 500) / 1000;
-	if (tmp > MAX_tRAS)
-		tmp = MAX_tRAS;
-
-	tmp = (tmp << DDR_CFG_TRAS_SHIFT) & DDR_CFG_TRAS_MASK;
-	reg = reg & ~DDR_CFG_TRAS_MASK;
-	reg = reg | tmp;
-
-	writel(reg, ddr_regs);
+	if (mem_type == AR934X_DDR2)
+		tmp = ddr_ns_to_clk(DDR2_tRFC_ns, ddr_mhz);
+	else
+		tmp = ddr_ns_to_clk(DDR1_tRFC_ns, ddr_mhz);
+
+	reg = ATH79_FIELD_SET(reg, AR934X_DDR_CONFIG_TRFC, tmp);
+	reg = ATH79_FIELD_SET(reg, AR934X_DDR_CONFIG_TRRD,
+			      ddr_ns_to_clk(DDRx_tRRD_ns, ddr_mhz));
+	reg = ATH79_FIELD_SET(reg, AR934X_DDR_CONFIG_TRP,
+			      ddr_ns_to_clk(DDRx_tRP_ns, ddr_mhz));
+	reg = ATH79_FIELD_SET(reg, AR934X_DDR_CONFIG_TRCD,
+			      ddr_ns_to_clk(DDRx_tRCD_ns, ddr_mhz));
+	reg = ATH79_FIELD_SET(reg, AR934X_DDR_CONFIG_TRAS,
+			      ddr_ns_to_clk(DDRx_tRAS_ns, ddr_mhz));
+
+	s->config = reg;
 #else
-	writel(CONFIG_ATH79_DDR_CFG_REG_VAL, ddr_regs);
+	s->config = CONFIG_ATH79_DDR_CFG_REG_VAL;
 #endif
-#ifndef CONFIG_ATH79_DDR_CFG2_REG_VAL
-	reg = readl(ddr_regs + AR71XX_DDR_REG_CONFIG2);
 
+#ifndef CONFIG_ATH79_DDR_CFG2_REG_VAL
 	/* Enable CKE */
-	reg = reg | DDR_CFG2_CKE_MASK;
+	reg = s->config2 | AR934X_DDR_CONFIG2_CKE;
 
 	/* Gate open latency = 2 * CAS_LAT */
-	tmp = 2 * cas_lat;
-	tmp = (tmp << DDR_CFG2_GATE_OPEN_LAT_SHIFT)
-					& DDR_CFG2_GATE_OPEN_LAT_MASK;
-	reg = reg & ~DDR_CFG2_GATE_OPEN_LAT_MASK;
-	reg = reg | tmp;
+	reg = ATH79_FIELD_SET(reg, AR934X_DDR_CONFIG2_GATE_OPEN_LAT,
+			      2 * cas_lat);
 
 	/* tWTR */
 	if (mem_type == AR934X_DDR2) {
@@ -466,27 +287,10 @@ void ar934x_ddr_init(const u16 cpu_mhz, const u16 ddr_mhz, const u16 ahb_mhz)
 			tmp = tmp + 2;
 	} else {
 		/* tWTR = 2 + BL + (2 * tWTR/tCK) */
-		tmp = 2 + DDR_burst_len
-					+ (((DDRx_tWTR_ns * ddr_mhz) + 500) / 1000);
+		tmp = 2 + DDR_burst_len + ddr_ns_to_clk(DDRx_tWTR_ns, ddr_mhz);
 	}
 
-	if (tmp > MAX_tWTR)
-		tmp = MAX_tWTR;
-
-	tmp = (tmp << DDR_CFG2_TWTR_SHIFT) & DDR_CFG2_TWTR_MASK;
-	reg = reg & ~DDR_CFG2_TWTR_MASK;
-	reg = reg | tmp;
-
-	/* tRTP */
-	if (ddr_width == 32) {
-		tmp = DDR_burst_len;
-	} else {
-		tmp = MAX_tRTP;
-	}
-
-	tmp = (tmp << DDR_CFG2_TRTP_SHIFT) & DDR_CFG2_TRTP_MASK;
-	reg = reg & ~DDR_CFG2_TRTP_MASK;
-	reg = reg | tmp;
+	reg = ATH79_FIELD_SET(reg, AR934X_DDR_CONFIG2_TWTR, tmp);
 
 	/* tRTW */
 	if (mem_type == AR934X_DDR2) {
@@ -497,35 +301,218 @@ void ar934x_ddr_init(const u16 cpu_mhz, const u16 ddr_mhz, const u16 ahb_mhz)
 		tmp = DDR_burst_len + (2 * cas_lat);
 	}
 
-	if (tmp > MAX_tRTW)
-		tmp = MAX_tRTW;
-
-	tmp = (tmp << DDR_CFG2_TRTW_SHIFT) & DDR_CFG2_TRTW_MASK;
-	reg = reg & ~DDR_CFG2_TRTW_MASK;
-	reg = reg | tmp;
+	reg = ATH79_FIELD_SET(reg, AR934X_DDR_CONFIG2_TRTW, tmp);
 
 	/* tWR */
-	tmp = ((DDRx_tWR_ns * ddr_mhz) + 500) / 1000;
-	if (tmp > MAX_tWR)
-		tmp = MAX_tWR;
-
-	tmp = (tmp << DDR_CFG2_TWR_SHIFT) & DDR_CFG2_TWR_MASK;
-	reg = reg & ~DDR_CFG2_TWR_MASK;
-	reg = reg | tmp;
+	reg = ATH79_FIELD_SET(reg, AR934X_DDR_CONFIG2_TWR,
+			      ddr_ns_to_clk(DDRx_tWR_ns, ddr_mhz));
 
 	/* Always use burst length = 8 and type: sequential */
-	tmp = (DDR_burst_len << DDR_CFG2_BURST_LEN_SHIFT)
-					& DDR_CFG2_BURST_LEN_MASK;
-	reg = reg & ~(DDR_CFG2_BURST_LEN_MASK
-					| DDR_CFG2_BURST_TYPE_MASK);
-	reg = reg | tmp;
+	reg &= ~AR934X_DDR_CONFIG2_BURST_TYPE;
+	reg = ATH79_FIELD_SET(reg, AR934X_DDR_CONFIG2_BURST_LEN,
+			      DDR_burst_len);
 
-	writel(reg, ddr_regs + AR71XX_DDR_REG_CONFIG2);
+	s->config2 = reg;
 #else
-	writel(CONFIG_ATH79_DDR_CFG2_REG_VAL,
-					ddr_regs + AR71XX_DDR_REG_CONFIG2);
+	s->config2 = CONFIG_ATH79_DDR_CFG2_REG_VAL;
 #endif
 
+	/* tRTP and read cycle depend on bus width */
+	ar934x_ddr_shadow_set_width(s, ddr_width);
+}
+
+/* Write composed values to the controller, one access per register */
+static void ar934x_ddr_shadow_commit(void __iomem *ddr_regs,
+				     const struct ar934x_ddr_shadow *s,
+				     u32 mem_type)
+{
+	writel(s->ctl_conf, ddr_regs + AR934X_DDR_REG_CTL_CONF);
+	writel(s->rd_cycle, ddr_regs + AR71XX_DDR_REG_RD_CYCLE);
+
+	if (s->fsm_wait_ctrl)
+		writel(s->fsm_wait_ctrl, ddr_regs + AR934X_DDR_REG_FSM_WAIT_CTRL);
+
+	if (mem_type == AR934X_DDR2)
+		writel(s->ddr2_config, ddr_regs + AR934X_DDR_REG_DDR2_CONFIG);
+
+	writel(s->config, ddr_regs + AR71XX_DDR_REG_CONFIG);
+	writel(s->config2, ddr_regs + AR71XX_DDR_REG_CONFIG2);
+}
+
+#ifndef CONFIG_BOARD_DRAM_DDR_WIDTH
+/*
+ * Write a set of patterns through KSEG1 and read them back.
+ * All patterns are written before any is read, so lanes which
+ * are not connected to a chip can't return the expected value
+ * just because the bus still holds it.
+ */
+static bool ar934x_ddr_lanes_ok(void)
+{
+	static const u32 patterns[] = {
+		0x00000000, 0xffffffff, 0xa5a5a5a5, 0x5a5a5a5a,
+		0x01020408, 0x80402010, 0x12345678, 0xfedcba98,
+	};
+	volatile u32 *addr = (void *)CKSEG1ADDR(DDR_PROBE_ADDR);
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(patterns); i++)
+		addr[i] = patterns[i];
+
+	for (i = 0; i < ARRAY_SIZE(patterns); i++)
+		if (addr[i] != patterns[i])
+			return false;
+
+	return true;
+}
+
+static void ar934x_ddr_set_width(void __iomem *ddr_regs,
+				 struct ar934x_ddr_shadow *s, u32 ddr_width)
+{
+	ar934x_ddr_shadow_set_width(s, ddr_width);
+	writel(s->ctl_conf, ddr_regs + AR934X_DDR_REG_CTL_CONF);
+	writel(s->rd_cycle, ddr_regs + AR71XX_DDR_REG_RD_CYCLE);
+	writel(s->config2, ddr_regs + AR71XX_DDR_REG_CONFIG2);
+}
+
+/*
+ * The lanes are first tested at the current taps. The reset default taps
+ * may be too far off for them to read back at all, so only when that
+ * fails the taps are tuned for this width and the test is repeated. The
+ * final tuning, for the width that is kept, is left to dram_init().
+ */
+static bool ar934x_ddr_width_ok(void)
+{
+	if (ar934x_ddr_lanes_ok())
+		return true;
+
+	ddr_tap_tuning();
+	return ar934x_ddr_lanes_ok();
+}
+
+/*
+ * Find the real data bus width. The controller is set up for 32-bit
+ * first, if upper lanes don't work we fall back to 16-bit. When neither
+ * passes the bootstrap value is used.
+ */
+static void ar934x_ddr_probe_width(void __iomem *ddr_regs,
+				   struct ar934x_ddr_shadow *s,
+				   u32 strap_width)
+{
+	if (ar934x_ddr_width_ok())
+		return;
+
+	ar934x_ddr_set_width(ddr_regs, s, 16);
+	if (ar934x_ddr_width_ok() || strap_width == 16)
+		return;
+
+	ar934x_ddr_set_width(ddr_regs, s, strap_width);
+}
+#endif
+
+void ar934x_ddr_init(const u16 cpu_mhz, const u16 ddr_mhz, const u16 ahb_mhz)
+{
+	struct ar934x_ddr_shadow shadow;
+	void __iomem *ddr_regs;
+	void __iomem *pll_regs;
+	u32 mem_type, tmp_clk;
+	u32 cas_lat, ddr_width, reg, wr_recovery;
+#ifndef CONFIG_BOARD_DRAM_DDR_WIDTH
+	u32 strap_width;
+#endif
+	bool fractional;
+
+	ddr_regs = map_physmem(AR71XX_DDR_CTRL_BASE, AR71XX_DDR_CTRL_SIZE,
+			       MAP_NOCACHE);
+
+	reg = ath79_get_bootstrap();
+	if (reg & AR934X_BOOTSTRAP_SDRAM_DISABLED) {	/* DDR */
+		if (reg & AR934X_BOOTSTRAP_DDR1) {	/* DDR 1 */
+			mem_type = AR934X_DDR1;
+		} else {				/* DDR 2 */
+			mem_type = AR934X_DDR2;
+		}
+	} else {					/* SDRAM */
+		mem_type = AR934X_SDRAM;
+	}
+
+	/* Set CAS based on clock, but allow to set static value */
+#ifndef CONFIG_BOARD_DRAM_CAS_LATENCY
+	if (mem_type == AR934X_DDR1) {
+		if (ddr_mhz <= 266) {
+			cas_lat = 2;
+		} else {
+			cas_lat = 3;
+		}
+	} else if (mem_type == AR934X_DDR2) {
+		if (ddr_mhz <= 400) {
+			cas_lat = 3;
+		} else if (ddr_mhz <= 533) {
+			cas_lat = 4;
+		} else if (ddr_mhz <= 666) {
+			cas_lat = 5;
+		} else if (ddr_mhz <= 800) {
+			cas_lat = 6;
+		} else {
+			cas_lat = 7;
+		}
+	} else { /* SDRAM */
+
+	}
+#else
+	cas_lat = CONFIG_BOARD_DRAM_CAS_LATENCY;
+#endif
+
+	/*
+	 * Bootstrap tells what the board designer intended, but the width
+	 * is verified by probing once the controller is up (see below).
+	 * Start with 32-bit, so a misstrapped board is not left at half
+	 * bandwidth.
+	 */
+#ifndef CONFIG_BOARD_DRAM_DDR_WIDTH
+	if (reg & BIT(3))
+		strap_width = 32;
+	else
+		strap_width = 16;
+
+	ddr_width = 32;
+#else
+	ddr_width = CONFIG_BOARD_DRAM_DDR_WIDTH;
+#endif
+
+	pll_regs = map_physmem(AR71XX_PLL_BASE, AR71XX_PLL_SIZE,
+			       MAP_NOCACHE);
+
+	reg = readl(pll_regs + AR934X_PLL_CPU_DIT_FRAC_REG);
+	fractional = ATH79_FIELD_GET(reg, AR934X_PLL_CPU_DIT_FRAC_MIN) != 0;
+
+	reg = readl(pll_regs + AR934X_PLL_DDR_DIT_FRAC_REG);
+	if (ATH79_FIELD_GET(reg, AR934X_PLL_DDR_DIT_FRAC_MIN))
+		fractional = true;
+
+	/* Check if clock is not too low for our "safe" timing values */
+	tmp_clk = ddr_mhz;
+	if (mem_type == AR934X_DDR1) {
+		if (tmp_clk < DDR1_timing_clk_max)
+			tmp_clk = DDR1_timing_clk_max;
+	} else if (mem_type == AR934X_DDR2) {
+		if (tmp_clk < DDR2_timing_clk_max)
+			tmp_clk = DDR2_timing_clk_max;
+	} else { /* SDRAM */
+
+	}
+
+	/* Read each register once, compose in CPU registers, write once */
+	shadow.ctl_conf = readl(ddr_regs + AR934X_DDR_REG_CTL_CONF);
+	shadow.ddr2_config = 0;
+	if (mem_type == AR934X_DDR2)
+		shadow.ddr2_config = readl(ddr_regs + AR934X_DDR_REG_DDR2_CONFIG);
+	shadow.config = readl(ddr_regs + AR71XX_DDR_REG_CONFIG);
+	shadow.config2 = readl(ddr_regs + AR71XX_DDR_REG_CONFIG2);
+
+	ar934x_ddr_shadow_compose(&shadow, mem_type, cas_lat, ddr_width,
+				  cpu_mhz, ddr_mhz, ahb_mhz, fractional);
+	ar934x_ddr_shadow_commit(ddr_regs, &shadow, mem_type);
+
 	/* Precharge all */
 	writel(DDR_CTRL_FORCE_PRECHRG_ALL_MASK,
 					ddr_regs + AR71XX_DDR_REG_CONTROL);
@@ -593,9 +580,13 @@ void ar934x_ddr_init(const u16 cpu_mhz, const u16 ddr_mhz, const u16 ahb_mhz)
 	else
 		writel(BIT(14) | 195, ddr_regs + AR71XX_DDR_REG_REFRESH);
 
+#ifndef CONFIG_BOARD_DRAM_DDR_WIDTH
+	ar934x_ddr_probe_width(ddr_regs, &shadow, strap_width);
+#endif
+
 	/*
-	 * At this point memory should be fully configured,
-	 * so we can perform delay tap controller tune.
+	 * At this point memory should be fully configured, the delay
+	 * taps are tuned for it once, in dram_init().
 	 */
 }
 
@@ -0,0 +1,131 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Copyright (C) 2024 Wojciech Cybowski <github.com/wcyb>
+ *
+ * Quiet boot: with "silent" set the console output is only recorded.
+ * The record is moved to a RAM area reserved for Linux right before
+ * the kernel starts, and printed on request, when the boot fails or
+ * when a key stops autoboot. Recording starts after relocation, what
+ * is printed before (banner, DRAM size) is neither shown nor kept.
+ */
+
+#include <command.h>
+#include <console.h>
+#include <cpu_func.h>
+#include <env.h>
+#include <membuf.h>
+#include <stdio.h>
+#include <vsprintf.h>
+#include <asm/global_data.h>
+#include <linux/types.h>
+#include <mach/bootlog.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* "UBLG", checked by the mt02-bootlog module in OpenWrt */
+#define BOOTLOG_MAGIC		0x55424c47
+
+struct ath79_bootlog {
+	u32 magic;
+	u32 len;
+	char data[];
+};
+
+static bool bootlog_started;
+
+static struct ath79_bootlog *ath79_bootlog_area(void)
+{
+	return (struct ath79_bootlog *)CONFIG_ATH79_BOOTLOG_ADDR;
+}
+
+/*
+ * Move everything recorded so far into the handoff area
+ */
+static struct ath79_bootlog *ath79_bootlog_collect(void)
+{
+	struct ath79_bootlog *log = ath79_bootlog_area();
+	int max = CONFIG_ATH79_BOOTLOG_SIZE - sizeof(*log);
+
+	if (!bootlog_started) {
+		log->magic = BOOTLOG_MAGIC;
+		log->len = 0;
+		bootlog_started = true;
+	}
+
+	if (gd->console_out.start)
+		log->len += membuf_get(&gd->console_out, log->data + log->len,
+				       max - log->len);
+
+	return log;
+}
+
+void ath79_bootlog_init(void)
+{
+	char buf[64];
+
+	/*
+	 * Reserve the handoff area in Linux, and keep the kernel quiet
+	 * as well when U-Boot is
+	 */
+	snprintf(buf, sizeof(buf), "%smemmap=%uK$0x%lx",
+		 (gd->flags & GD_FLG_SILENT) ? "quiet " : "",
+		 CONFIG_ATH79_BOOTLOG_SIZE >> 10,
+		 (ulong)CONFIG_ATH79_BOOTLOG_ADDR & 0x1fffffff);
+	env_set("bootlog", buf);
+}
+
+/*
+ * Print the boot log and leave quiet mode for good
+ */
+void ath79_bootlog_show(void)
+{
+	struct ath79_bootlog *log = ath79_bootlog_collect();
+	u32 i;
+
+	gd->flags &= ~(GD_FLG_SILENT | GD_FLG_RECORD);
+	env_set("silent", NULL);
+
+	for (i = 0; i < log->len; i++)
+		putc(log->data[i]);
+
+	ath79_bootlog_init();
+}
+
+/*
+ * Autoboot turns the console back on when a key stops it, but what was
+ * recorded until then would not be printed. With bootdelay 0 it only
+ * looks for a key that is already waiting, check for it the same way
+ * right before. Other delays show a countdown or go straight to the
+ * prompt, leave quiet mode for them as well. -2 can't be stopped.
+ */
+void ath79_bootlog_autoboot(void)
+{
+	int delay = env_get_int("bootdelay", CONFIG_BOOTDELAY);
+
+	if (!(gd->flags & GD_FLG_SILENT) || delay == -2)
+		return;
+
+	if (delay != 0 || tstc())
+		ath79_bootlog_show();
+}
+
+void board_preboot_os(void)
+{
+	struct ath79_bootlog *log = ath79_bootlog_collect();
+
+	flush_dcache_range((ulong)log,
+			   (ulong)log + sizeof(*log) + log->len);
+}
+
+static int do_bootlog(struct cmd_tbl *cmdtp, int flag, int argc,
+		      char *const argv[])
+{
+	ath79_bootlog_show();
+
+	return CMD_RET_SUCCESS;
+}
+
+U_BOOT_CMD(bootlog, 1, 0, do_bootlog,
+	   "print the recorded boot log and turn the console back on",
+	   ""
+);
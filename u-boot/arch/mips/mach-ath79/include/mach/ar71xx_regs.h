@@ -13,6 +13,7 @@
 
 #ifndef __ASSEMBLY__
 #include <linux/bitops.h>
+#include <linux/types.h>
 #else
 #ifndef BIT
 #define BIT(nr)		(1 << (nr))
@@ -301,6 +302,49 @@
 #define QCA956X_DDR_REG_CTL_CONF			0x108
 #define QCA956X_DDR_REG_DDR3_CONFIG			0x15c
 
+#define AR934X_DDR_CONFIG_CAS_MSB			BIT(31)
+#define AR934X_DDR_CONFIG_PAGE_CLOSE			BIT(30)
+#define AR934X_DDR_CONFIG_CAS_3LSB_SHIFT		27
+#define AR934X_DDR_CONFIG_CAS_3LSB_MASK			0x7
+#define AR934X_DDR_CONFIG_TMRD_SHIFT			23
+#define AR934X_DDR_CONFIG_TMRD_MASK			0xf
+#define AR934X_DDR_CONFIG_TRFC_SHIFT			17
+#define AR934X_DDR_CONFIG_TRFC_MASK			0x3f
+#define AR934X_DDR_CONFIG_TRRD_SHIFT			13
+#define AR934X_DDR_CONFIG_TRRD_MASK			0xf
+#define AR934X_DDR_CONFIG_TRP_SHIFT			9
+#define AR934X_DDR_CONFIG_TRP_MASK			0xf
+#define AR934X_DDR_CONFIG_TRCD_SHIFT			5
+#define AR934X_DDR_CONFIG_TRCD_MASK			0xf
+#define AR934X_DDR_CONFIG_TRAS_SHIFT			0
+#define AR934X_DDR_CONFIG_TRAS_MASK			0x1f
+
+#define AR934X_DDR_CONFIG2_GATE_OPEN_LAT_SHIFT		26
+#define AR934X_DDR_CONFIG2_GATE_OPEN_LAT_MASK		0xf
+#define AR934X_DDR_CONFIG2_TWTR_SHIFT			21
+#define AR934X_DDR_CONFIG2_TWTR_MASK			0x1f
+#define AR934X_DDR_CONFIG2_TRTP_SHIFT			17
+#define AR934X_DDR_CONFIG2_TRTP_MASK			0xf
+#define AR934X_DDR_CONFIG2_TRTW_SHIFT			12
+#define AR934X_DDR_CONFIG2_TRTW_MASK			0x1f
+#define AR934X_DDR_CONFIG2_TWR_SHIFT			8
+#define AR934X_DDR_CONFIG2_TWR_MASK			0xf
+#define AR934X_DDR_CONFIG2_CKE				BIT(7)
+#define AR934X_DDR_CONFIG2_BURST_TYPE			BIT(4)
+#define AR934X_DDR_CONFIG2_BURST_LEN_SHIFT		0
+#define AR934X_DDR_CONFIG2_BURST_LEN_MASK		0xf
+
+#define AR934X_DDR_DDR2_CONFIG_TWL_SHIFT		10
+#define AR934X_DDR_DDR2_CONFIG_TWL_MASK			0xf
+#define AR934X_DDR_DDR2_CONFIG_TFAW_SHIFT		2
+#define AR934X_DDR_DDR2_CONFIG_TFAW_MASK		0x3f
+#define AR934X_DDR_DDR2_CONFIG_EN			BIT(0)
+
+#define AR934X_DDR_CTL_CONF_PAD_DDR2_SEL		BIT(6)
+#define AR934X_DDR_CTL_CONF_SRAM_REQ_ACK		BIT(3)
+#define AR934X_DDR_CTL_CONF_CPU_DDR_SYNC		BIT(2)
+#define AR934X_DDR_CTL_CONF_HALF_WIDTH			BIT(1)
+
 /*
  * PLL block
  */
@@ -1349,4 +1393,36 @@
 
 #define QCA956X_ETH_CFG_GE0_SGMII			BIT(6)
 
+#ifndef __ASSEMBLY__
+/*
+ * Register field helpers, for use with the _SHIFT and _MASK pairs above.
+ * Values wider than the field are clamped to the field maximum, which
+ * is what the timing calculations want.
+ */
+static inline u32 ath79_field_prep(u32 mask, u32 shift, u32 val)
+{
+	if (val > mask)
+		val = mask;
+
+	return val << shift;
+}
+
+static inline u32 ath79_field_get(u32 reg, u32 mask, u32 shift)
+{
+	return (reg >> shift) & mask;
+}
+
+static inline u32 ath79_field_set(u32 reg, u32 mask, u32 shift, u32 val)
+{
+	return (reg & ~(mask << shift)) | ath79_field_prep(mask, shift, val);
+}
+
+#define ATH79_FIELD_PREP(_field, _val) \
+	ath79_field_prep(_field##_MASK, _field##_SHIFT, (_val))
+#define ATH79_FIELD_GET(_reg, _field) \
+	ath79_field_get((_reg), _field##_MASK, _field##_SHIFT)
+#define ATH79_FIELD_SET(_reg, _field, _val) \
+	ath79_field_set((_reg), _field##_MASK, _field##_SHIFT, (_val))
+#endif
+
 #endif /* __ASM_AR71XX_H */
@@ -0,0 +1,19 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Copyright (C) 2024 Wojciech Cybowski <github.com/wcyb>
+ */
+
+#ifndef __ASM_MACH_BOOTLOG_H
+#define __ASM_MACH_BOOTLOG_H
+
+#ifdef CONFIG_ATH79_BOOTLOG
+void ath79_bootlog_init(void);
+void ath79_bootlog_show(void);
+void ath79_bootlog_autoboot(void);
+#else
+static inline void ath79_bootlog_init(void) {}
+static inline void ath79_bootlog_show(void) {}
+static inline void ath79_bootlog_autoboot(void) {}
+#endif
+
+#endif /* __ASM_MACH_BOOTLOG_H */
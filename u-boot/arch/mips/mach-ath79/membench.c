@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Copyright (C) 2024 Wojciech Cybowski <github.com/wcyb>
+ *
+ * Throughput of memcpy and memset compared to a plain word loop,
+ * used to check the assembly versions and their prefetch distance.
+ */
+
+#include <command.h>
+#include <div64.h>
+#include <mapmem.h>
+#include <time.h>
+#include <vsprintf.h>
+#include <linux/string.h>
+#include <linux/types.h>
+
+enum membench_test {
+	MEMBENCH_MEMCPY,
+	MEMBENCH_WORD_COPY,
+	MEMBENCH_MEMSET,
+	MEMBENCH_WORD_FILL,
+};
+
+static const char * const membench_names[] = {
+	[MEMBENCH_MEMCPY]	= "memcpy",
+	[MEMBENCH_WORD_COPY]	= "word copy",
+	[MEMBENCH_MEMSET]	= "memset",
+	[MEMBENCH_WORD_FILL]	= "word fill",
+};
+
+/* volatile, so the compiler can't turn the loops into memcpy/memset */
+static void membench_word_copy(volatile u32 *dst, const volatile u32 *src,
+			       ulong len)
+{
+	for (len /= 4; len; len--)
+		*dst++ = *src++;
+}
+
+static void membench_word_fill(volatile u32 *dst, ulong len)
+{
+	for (len /= 4; len; len--)
+		*dst++ = 0;
+}
+
+static void membench_run(enum membench_test test, void *dst, void *src,
+			 ulong len, ulong loops)
+{
+	u64 start, us;
+	ulong i;
+
+	start = timer_get_us();
+	for (i = 0; i < loops; i++) {
+		switch (test) {
+		case MEMBENCH_MEMCPY:
+			memcpy(dst, src, len);
+			break;
+		case MEMBENCH_WORD_COPY:
+			membench_word_copy(dst, src, len);
+			break;
+		case MEMBENCH_MEMSET:
+			memset(dst, 0, len);
+			break;
+		case MEMBENCH_WORD_FILL:
+			membench_word_fill(dst, len);
+			break;
+		}
+	}
+	us = timer_get_us() - start;
+
+	/* Bytes per microsecond are MB/s */
+	printf("%-10s %8llu us %6llu MB/s\n", membench_names[test], us,
+	       lldiv((u64)len * loops, us ? us : 1));
+}
+
+static int do_membench(struct cmd_tbl *cmdtp, int flag, int argc,
+		       char *const argv[])
+{
+	ulong dst, src, len, loops = 16;
+	void *d, *s;
+	int test;
+
+	if (argc < 4)
+		return CMD_RET_USAGE;
+
+	dst = hextoul(argv[1], NULL);
+	src = hextoul(argv[2], NULL);
+	len = hextoul(argv[3], NULL) & ~3UL;
+	if (argc > 4)
+		loops = dectoul(argv[4], NULL);
+
+	if (!len || !loops)
+		return CMD_RET_USAGE;
+
+	d = map_sysmem(dst, len);
+	s = map_sysmem(src, len);
+
+#if IS_ENABLED(CONFIG_ATH79_MEMCPY) || IS_ENABLED(CONFIG_ATH79_MEMSET)
+	printf("prefetch ahead %d bytes\n", CONFIG_ATH79_PREF_AHEAD);
+#endif
+
+	for (test = MEMBENCH_MEMCPY; test <= MEMBENCH_WORD_FILL; test++)
+		membench_run(test, d, s, len, loops);
+
+	unmap_sysmem(s);
+	unmap_sysmem(d);
+
+	return CMD_RET_SUCCESS;
+}
+
+U_BOOT_CMD(membench, 5, 0, do_membench,
+	   "measure memcpy and memset throughput",
+	   "dst src len [loops]\n"
+	   "    - copy len bytes from src to dst and fill dst, loops times\n"
+	   "      (default 16), with the linked memcpy/memset and a word loop"
+);
@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Copyright (C) 2024 Wojciech Cybowski <github.com/wcyb>
+ *
+ * 16550 UART of the AR934x and QCA953x with a baud rate check. The
+ * UART runs from the 25 MHz reference, only few rates above 230400
+ * divide from it well enough for the other side to sample them.
+ * "setenv baudrate" is checked against CFG_SYS_BAUDRATE_TABLE, but
+ * "loadb/loady <addr> <baud>" pass any rate to setbrg. Here a rate
+ * more than 3.5% off is refused, the UART keeps its current rate.
+ */
+
+#include <dm.h>
+#include <errno.h>
+#include <ns16550.h>
+#include <serial.h>
+#include <stdio.h>
+#include <linux/kernel.h>
+
+/* Largest baud rate error accepted, in 0.1% */
+#define ATH79_SERIAL_MAX_ERROR		35
+
+static int ath79_serial_putc(struct udevice *dev, const char ch)
+{
+	return ns16550_serial_ops.putc(dev, ch);
+}
+
+static int ath79_serial_pending(struct udevice *dev, bool input)
+{
+	return ns16550_serial_ops.pending(dev, input);
+}
+
+static int ath79_serial_getc(struct udevice *dev)
+{
+	return ns16550_serial_ops.getc(dev);
+}
+
+/*
+ * Same divisor as ns16550_calc_divisor(), the rate is rejected when
+ * the one it gives is too far from the requested one
+ */
+static int ath79_serial_setbrg(struct udevice *dev, int baudrate)
+{
+	struct ns16550_plat *plat = dev_get_plat(dev);
+	ulong clock = plat->clock;
+	ulong div, actual, error;
+
+	if (baudrate <= 0 || baudrate > clock / 16) {
+		printf("## Baudrate %d bps not possible with a %lu Hz UART clock\n",
+		       baudrate, clock);
+		return -EINVAL;
+	}
+
+	div = DIV_ROUND_CLOSEST(clock, 16 * baudrate);
+	actual = clock / (16 * div);
+	error = DIV_ROUND_CLOSEST(abs((long)actual - baudrate) * 1000,
+				  (ulong)baudrate);
+
+	if (error > ATH79_SERIAL_MAX_ERROR) {
+		printf("## Baudrate %d bps is %lu.%lu%% off (%lu bps), not changed\n",
+		       baudrate, error / 10, error % 10, actual);
+		return -EINVAL;
+	}
+
+	return ns16550_serial_ops.setbrg(dev, baudrate);
+}
+
+static int ath79_serial_setconfig(struct udevice *dev, uint serial_config)
+{
+	return ns16550_serial_ops.setconfig(dev, serial_config);
+}
+
+static int ath79_serial_getinfo(struct udevice *dev,
+				struct serial_device_info *info)
+{
+	return ns16550_serial_ops.getinfo(dev, info);
+}
+
+static const struct dm_serial_ops ath79_serial_ops = {
+	.putc = ath79_serial_putc,
+	.pending = ath79_serial_pending,
+	.getc = ath79_serial_getc,
+	.setbrg = ath79_serial_setbrg,
+	.setconfig = ath79_serial_setconfig,
+	.getinfo = ath79_serial_getinfo,
+};
+
+static const struct udevice_id ath79_serial_ids[] = {
+	{ .compatible = "qca,ath79-ns16550" },
+	{ }
+};
+
+U_BOOT_DRIVER(ath79_serial) = {
+	.name = "ath79_serial",
+	.id = UCLASS_SERIAL,
+	.of_match = ath79_serial_ids,
+	.of_to_plat = ns16550_serial_of_to_plat,
+	.plat_auto = sizeof(struct ns16550_plat),
+	.priv_auto = sizeof(struct ns16550),
+	.probe = ns16550_serial_probe,
+	.ops = &ath79_serial_ops,
+};
@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Copyright (C) 2024 Wojciech Cybowski <github.com/wcyb>
+ */
+
+#include <hang.h>
+#include <init.h>
+#include <spl.h>
+#include <asm/sections.h>
+#include <linux/string.h>
+
+void __noreturn board_init_f(ulong dummy)
+{
+	int ret;
+
+	/*
+	 * PLL and DDR setup is done by the board, U-Boot proper is
+	 * decompressed into RAM right after it
+	 */
+	board_early_init_f();
+
+	/* BSS is in RAM, so it can only be cleared once DDR is up */
+	memset(__bss_start, 0, __bss_end - __bss_start);
+
+	ret = spl_init();
+	if (ret)
+		hang();
+
+	board_init_r(NULL, 0);
+}
+
+u32 spl_boot_device(void)
+{
+	return BOOT_DEVICE_NOR;
+}
@@ -3,15 +3,44 @@
  * Copyright (C) 2024 Wojciech Cybowski <github.com/wcyb>
  */
 
+#include <command.h>
+#include <dm.h>
+#include <env.h>
 #include <init.h>
+#include <net.h>
+#include <spi_flash.h>
+#include <stdio.h>
+#include <time.h>
+#include <vsprintf.h>
+#include <asm/global_data.h>
 #include <asm/io.h>
 #include <asm/addrspace.h>
 #include <asm/types.h>
+#include <linux/delay.h>
 #include <mach/ar71xx_regs.h>
+#include <mach/bootlog.h>
 #include <mach/ddr.h>
 #include <mach/ath79.h>
 #include <debug_uart.h>
 
+DECLARE_GLOBAL_DATA_PTR;
+
+/*
+ * ART partition in the memory mapped flash, MAC address of eth0 is
+ * stored at its beginning (macaddr@0 in the OpenWrt DTS)
+ */
+#define MT02_ART_BASE			0x9f060000
+#define MT02_ART_ETH0_MAC		0x0
+
+/*
+ * The firmware partition goes from here to the end of the flash,
+ * the recovery must not write an image bigger than that
+ */
+#define MT02_FIRMWARE_OFFSET		0x70000
+
+/* Time to stop the recovery with a key when the button is held */
+#define MT02_RECOVERY_DELAY_MS		3000
+
 #ifdef CONFIG_DEBUG_UART_BOARD_INIT
 void board_debug_uart_init(void)
 {
@@ -62,7 +91,114 @@ int board_early_init_f(void)
 	val |= QCA953X_GPIO_FUNC_JTAG_DISABLE;
 	writel(val, regs + QCA953X_GPIO_REG_FUNC);
 
-	ddr_init();
-	ath79_eth_reset();
+	/*
+	 * With SPL the clocks and DDR are already set up when
+	 * U-Boot proper starts from RAM
+	 */
+	if (!IS_ENABLED(CONFIG_SPL) || IS_ENABLED(CONFIG_XPL_BUILD))
+		ddr_init();
+
+	if (!IS_ENABLED(CONFIG_XPL_BUILD))
+		ath79_eth_reset();
+	return 0;
+}
+
+static bool mt02_button_held(void)
+{
+	void __iomem *regs;
+	int gpio;
+	u32 val;
+
+	gpio = ofnode_conf_read_int("mt02,reset-button-gpio", -1);
+	if (gpio < 0 || gpio > 31)
+		return false;
+
+	regs = map_physmem(AR71XX_GPIO_BASE, AR71XX_GPIO_SIZE,
+			   MAP_NOCACHE);
+
+	/*
+	 * Make sure the button GPIO is an input, it is active low
+	 */
+	val = readl(regs + AR71XX_GPIO_REG_OE);
+	val |= BIT(gpio);
+	writel(val, regs + AR71XX_GPIO_REG_OE);
+
+	return !(readl(regs + AR71XX_GPIO_REG_IN) & BIT(gpio));
+}
+
+static void mt02_set_ethaddr(void)
+{
+	u8 mac[ARP_HLEN];
+
+	if (env_get("ethaddr"))
+		return;
+
+	memcpy(mac, (void *)(MT02_ART_BASE + MT02_ART_ETH0_MAC), ARP_HLEN);
+	if (is_valid_ethaddr(mac))
+		eth_env_set_enetaddr("ethaddr", mac);
+}
+
+static void mt02_set_firmware_size(void)
+{
+	struct spi_flash *flash;
+	struct udevice *dev;
+
+	if (uclass_first_device_err(UCLASS_SPI_FLASH, &dev))
+		return;
+
+	flash = dev_get_uclass_priv(dev);
+	env_set_hex("firmware_size", flash->size - MT02_FIRMWARE_OFFSET);
+}
+
+/*
+ * A key press is left unread, autoboot then sees it as well and
+ * stops in the console instead of booting
+ */
+static bool mt02_recovery_stopped(void)
+{
+	ulong start = get_timer(0);
+
+	while (get_timer(start) < MT02_RECOVERY_DELAY_MS) {
+		if (tstc())
+			return true;
+		udelay(10000);
+	}
+
+	return false;
+}
+
+int board_late_init(void)
+{
+	char buf[16];
+
+	/*
+	 * RAM size is probed by address aliasing in dram_init(),
+	 * pass it to the kernel through "mem=${memsize}" in bootargs
+	 */
+	snprintf(buf, sizeof(buf), "%luM", (ulong)(gd->ram_size >> 20));
+	env_set("memsize", buf);
+
+	ath79_bootlog_init();
+
+	mt02_set_ethaddr();
+	mt02_set_firmware_size();
+
+	/*
+	 * Boot right away (BOOTDELAY=0) unless the reset button is
+	 * held at power-on, then show what was printed so far and
+	 * run the network recovery once, which can still be stopped
+	 * with a key to stay in the console. bootcmd is left as it
+	 * is, so a later saveenv can't make the recovery permanent.
+	 */
+	if (mt02_button_held()) {
+		ath79_bootlog_show();
+		printf("Reset button held, press any key to stop recovery\n");
+		if (!mt02_recovery_stopped())
+			run_command("run recovery", 0);
+	}
+
+	/* Print the boot log if a key is going to stop autoboot */
+	ath79_bootlog_autoboot();
+
 	return 0;
 }
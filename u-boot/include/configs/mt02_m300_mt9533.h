@@ -11,9 +11,43 @@
 #define CFG_SYS_INIT_RAM_ADDR        0xbd000000
 #define CFG_SYS_INIT_RAM_SIZE        0x2000
 
+/*
+ * SPL loads the LZMA compressed U-Boot image placed right after it
+ */
+#define CFG_SYS_UBOOT_BASE           0x9f010000
+
 /*
  * Serial Port
  */
 #define CFG_SYS_NS16550_CLK          25000000
 
+/*
+ * Only rates the 25 MHz UART clock divides to within 3.5%,
+ * 390625, 781250 and 1562500 are exact (divisor 4, 2 and 1).
+ * 460800 and 921600 would be off by 13% and 15%.
+ * "setenv baudrate" is checked against this table, a rate given to
+ * "loadb/loady" by the divisor error (ATH79_SERIAL).
+ */
+#define CFG_SYS_BAUDRATE_TABLE       { 9600, 19200, 38400, 57600, 115200, \
+				       230400, 390625, 781250, 1562500 }
+
+/*
+ * Quiet boot, the console output is recorded and printed by "bootlog".
+ * Recovery fetches a sysupgrade image over TFTP, or over HTTP when that
+ * fails, checks its uImage header and size (firmware_size is set by
+ * the board from the flash size) and writes it to the firmware
+ * partition, it is started by holding the reset button at power-on.
+ */
+#define CFG_EXTRA_ENV_SETTINGS \
+	"silent=1\0" \
+	"ipaddr=192.168.1.1\0" \
+	"serverip=192.168.1.10\0" \
+	"recovery_file=recovery.bin\0" \
+	"recovery_fetch=tftpboot ${loadaddr} ${recovery_file} || " \
+		"wget ${loadaddr} ${serverip}:/${recovery_file}\0" \
+	"recovery=run recovery_fetch && iminfo ${loadaddr} && " \
+		"itest ${filesize} -le ${firmware_size} && " \
+		"sf probe && sf update ${loadaddr} 0x70000 ${filesize} && " \
+		"reset\0"
+
 #endif  /* __CONFIG_H */
@@ -0,0 +1,198 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Copyright (C) 2024 Wojciech Cybowski <github.com/wcyb>
+ *
+ * Host check for the AR934x DDR shadow registers: runs ar934x_ddr_init()
+ * and the old read-modify-write sequence (ar934x_ddr_ref.c) against a
+ * fake register file, for DDR1/DDR2, both clock setups of the MT02 and a
+ * set of dithered PLLs, and compares what ends up in the controller and
+ * the order it is written in.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fake_regs.h>
+#include <linux/kernel.h>
+#include <mach/ar71xx_regs.h>
+
+void ar934x_ddr_init(const u16 cpu_mhz, const u16 ddr_mhz, const u16 ahb_mhz);
+void ref_ddr_init(const u16 cpu_mhz, const u16 ddr_mhz, const u16 ahb_mhz);
+
+uint32_t fake_ddr[FAKE_REGS_WORDS];
+uint32_t fake_pll[FAKE_REGS_WORDS];
+uint32_t fake_bootstrap;
+struct fake_write fake_log[FAKE_LOG_MAX];
+int fake_log_len;
+
+void *fake_map(unsigned long base)
+{
+	if (base == AR71XX_DDR_CTRL_BASE)
+		return fake_ddr;
+	if (base == AR71XX_PLL_BASE)
+		return fake_pll;
+	fprintf(stderr, "unexpected map of 0x%08lx\n", base);
+	exit(2);
+}
+
+uint32_t fake_readl(const volatile void *addr)
+{
+	return *(const volatile uint32_t *)addr;
+}
+
+void fake_writel(uint32_t val, volatile void *addr)
+{
+	uintptr_t off = (uintptr_t)addr - (uintptr_t)fake_ddr;
+
+	*(volatile uint32_t *)addr = val;
+	if (off >= sizeof(fake_ddr))
+		return;
+	if (fake_log_len == FAKE_LOG_MAX) {
+		fprintf(stderr, "write log overflow\n");
+		exit(2);
+	}
+	fake_log[fake_log_len].offset = off;
+	fake_log[fake_log_len].val = val;
+	fake_log_len++;
+}
+
+struct run {
+	uint32_t regs[FAKE_REGS_WORDS];
+	struct fake_write log[FAKE_LOG_MAX];
+	int log_len;
+};
+
+struct clocks {
+	u16 cpu, ddr, ahb;
+};
+
+/* MT02 runs 560/480/240, the rest covers the sync and FSM wait branches */
+static const struct clocks clocks[] = {
+	{ 560, 480, 240 },
+	{ 535, 400, 200 },
+	{ 400, 400, 200 },
+	{ 500, 200, 150 },
+	{ 300, 600, 400 },
+};
+
+static const uint32_t config_regs[] = {
+	AR934X_DDR_REG_CTL_CONF,
+	AR71XX_DDR_REG_RD_CYCLE,
+	AR934X_DDR_REG_FSM_WAIT_CTRL,
+	AR934X_DDR_REG_DDR2_CONFIG,
+	AR71XX_DDR_REG_CONFIG,
+	AR71XX_DDR_REG_CONFIG2,
+};
+
+static void run(void (*init)(const u16, const u16, const u16),
+		const struct clocks *c, const uint32_t *reset, struct run *r)
+{
+	memcpy(fake_ddr, reset, sizeof(fake_ddr));
+	fake_log_len = 0;
+	init(c->cpu, c->ddr, c->ahb);
+	memcpy(r->regs, fake_ddr, sizeof(fake_ddr));
+	memcpy(r->log, fake_log, sizeof(fake_log));
+	r->log_len = fake_log_len;
+}
+
+/* Index of the first write to DDR_CONTROL, the start of the mode sequence */
+static int mode_start(const struct run *r)
+{
+	int i;
+
+	for (i = 0; i < r->log_len; i++)
+		if (r->log[i].offset == AR71XX_DDR_REG_CONTROL)
+			return i;
+	return r->log_len;
+}
+
+static int compare(const char *name, const struct run *ref,
+		   const struct run *new)
+{
+	int ref_mode = mode_start(ref), new_mode = mode_start(new);
+	int i, j, last = -1, errors = 0;
+
+	for (i = 0; i < FAKE_REGS_WORDS; i++) {
+		if (ref->regs[i] == new->regs[i])
+			continue;
+		printf("%s: reg 0x%03x is 0x%08x, was 0x%08x\n", name, i * 4,
+		       new->regs[i], ref->regs[i]);
+		errors++;
+	}
+
+	/* Configuration registers: each at most once, in config_regs order */
+	for (i = 0; i < new_mode; i++) {
+		for (j = 0; j < (int)ARRAY_SIZE(config_regs); j++)
+			if (new->log[i].offset == config_regs[j])
+				break;
+		if (j == ARRAY_SIZE(config_regs) || j <= last) {
+			printf("%s: write %d to 0x%03x out of order\n", name, i,
+			       new->log[i].offset);
+			errors++;
+		}
+		last = j;
+	}
+
+	/* Mode register sequence: unchanged */
+	if (ref->log_len - ref_mode != new->log_len - new_mode) {
+		printf("%s: %d mode writes, were %d\n", name,
+		       new->log_len - new_mode, ref->log_len - ref_mode);
+		return errors + 1;
+	}
+	for (i = 0; i < ref->log_len - ref_mode; i++) {
+		const struct fake_write *a = &ref->log[ref_mode + i];
+		const struct fake_write *b = &new->log[new_mode + i];
+
+		if (a->offset == b->offset && a->val == b->val)
+			continue;
+		printf("%s: mode write %d is 0x%08x to 0x%03x, was 0x%08x to 0x%03x\n",
+		       name, i, b->val, b->offset, a->val, a->offset);
+		errors++;
+	}
+
+	return errors;
+}
+
+int main(void)
+{
+	static const uint32_t types[] = {
+		AR934X_BOOTSTRAP_SDRAM_DISABLED | AR934X_BOOTSTRAP_DDR1,
+		AR934X_BOOTSTRAP_SDRAM_DISABLED,
+	};
+	static uint32_t reset[FAKE_REGS_WORDS];
+	static struct run ref, new;
+	unsigned int t, c, seed, cases = 0;
+	int errors = 0;
+	char name[64];
+
+	for (seed = 1; seed <= 16; seed++) {
+		/* Random reset contents, so untouched bits must survive too */
+		srand(seed);
+		for (t = 0; t < FAKE_REGS_WORDS; t++)
+			reset[t] = ((uint32_t)rand() << 16) ^ rand();
+
+		/* Dither fractions zero, or not, to cover the sync decision */
+		memset(fake_pll, 0, sizeof(fake_pll));
+		if (seed & 1)
+			fake_pll[AR934X_PLL_CPU_DIT_FRAC_REG / 4] = reset[0];
+		if (seed & 2)
+			fake_pll[AR934X_PLL_DDR_DIT_FRAC_REG / 4] = reset[1];
+
+		for (t = 0; t < ARRAY_SIZE(types); t++) {
+			for (c = 0; c < ARRAY_SIZE(clocks); c++) {
+				fake_bootstrap = types[t] |
+						 ((seed & 4) ? AR934X_BOOTSTRAP_REF_CLK_40 : 0);
+				run(ref_ddr_init, &clocks[c], reset, &ref);
+				run(ar934x_ddr_init, &clocks[c], reset, &new);
+				snprintf(name, sizeof(name), "%s %u/%u/%u seed %u",
+					 t ? "DDR2" : "DDR1", clocks[c].cpu,
+					 clocks[c].ddr, clocks[c].ahb, seed);
+				errors += compare(name, &ref, &new);
+				cases++;
+			}
+		}
+	}
+
+	printf("%u cases, %d differences\n", cases, errors);
+	return errors ? 1 : 0;
+}
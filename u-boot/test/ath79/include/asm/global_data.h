@@ -0,0 +1,7 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+#ifndef __FAKE_ASM_GLOBAL_DATA_H
+#define __FAKE_ASM_GLOBAL_DATA_H
+
+#define DECLARE_GLOBAL_DATA_PTR
+
+#endif
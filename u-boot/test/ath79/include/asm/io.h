@@ -0,0 +1,12 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+#ifndef __FAKE_ASM_IO_H
+#define __FAKE_ASM_IO_H
+
+#include <fake_regs.h>
+
+#define MAP_NOCACHE		0
+#define map_physmem(_base, _size, _flags)	fake_map(_base)
+#define readl(_addr)		fake_readl(_addr)
+#define writel(_val, _addr)	fake_writel((_val), (_addr))
+
+#endif
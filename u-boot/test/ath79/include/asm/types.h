@@ -0,0 +1,7 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+#ifndef __FAKE_ASM_TYPES_H
+#define __FAKE_ASM_TYPES_H
+
+#include <linux/types.h>
+
+#endif
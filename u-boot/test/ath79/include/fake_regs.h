@@ -0,0 +1,31 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Copyright (C) 2024 Wojciech Cybowski <github.com/wcyb>
+ *
+ * Register file and write log shared by the host checks in this folder.
+ */
+
+#ifndef __FAKE_REGS_H
+#define __FAKE_REGS_H
+
+#include <stdint.h>
+
+#define FAKE_REGS_WORDS		0x100
+#define FAKE_LOG_MAX		256
+
+struct fake_write {
+	uint32_t offset;
+	uint32_t val;
+};
+
+extern uint32_t fake_ddr[FAKE_REGS_WORDS];
+extern uint32_t fake_pll[FAKE_REGS_WORDS];
+extern uint32_t fake_bootstrap;
+extern struct fake_write fake_log[FAKE_LOG_MAX];
+extern int fake_log_len;
+
+void *fake_map(unsigned long base);
+uint32_t fake_readl(const volatile void *addr);
+void fake_writel(uint32_t val, volatile void *addr);
+
+#endif
@@ -0,0 +1,7 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+#ifndef __FAKE_LINUX_BITOPS_H
+#define __FAKE_LINUX_BITOPS_H
+
+#define BIT(_nr)		(1UL << (_nr))
+
+#endif
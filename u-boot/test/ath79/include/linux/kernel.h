@@ -0,0 +1,7 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+#ifndef __FAKE_LINUX_KERNEL_H
+#define __FAKE_LINUX_KERNEL_H
+
+#define ARRAY_SIZE(_a)		(sizeof(_a) / sizeof((_a)[0]))
+
+#endif
@@ -0,0 +1,15 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+#ifndef __FAKE_LINUX_TYPES_H
+#define __FAKE_LINUX_TYPES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+#define __iomem
+
+#endif
@@ -0,0 +1,9 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+#ifndef __FAKE_MACH_ATH79_H
+#define __FAKE_MACH_ATH79_H
+
+#include <fake_regs.h>
+
+#define ath79_get_bootstrap()	fake_bootstrap
+
+#endif
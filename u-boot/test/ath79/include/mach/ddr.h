@@ -0,0 +1,10 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+#ifndef __FAKE_MACH_DDR_H
+#define __FAKE_MACH_DDR_H
+
+#include <linux/types.h>
+
+void ar934x_ddr_init(const u16 cpu_mhz, const u16 ddr_mhz, const u16 ahb_mhz);
+void ddr_tap_tuning(void);
+
+#endif